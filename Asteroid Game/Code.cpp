@@ -1,350 +1,4251 @@
 
 #include <SFML/Graphics.hpp>
+#ifndef ASTEROID_HEADLESS
 #include <SFML/Audio.hpp>
+#include <SFML/Network.hpp>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <iostream>
 #include <memory>
 #include <random>
+#include <sstream>
+#include <string>
 #include <vector>
+#include <cstdint>
 #include <cmath>
-#include <list>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// the headless benchmark always counts the heap allocations, the game only when built with the flag
+#if defined(ASTEROID_HEADLESS)  and  not defined(ASTEROID_COUNT_ALLOCATIONS)
+#define ASTEROID_COUNT_ALLOCATIONS
+#endif
+
+
+#ifdef ASTEROID_COUNT_ALLOCATIONS
+#include <new>
+#if defined(_MSC_VER)
+#define ASTEROID_NOINLINE __declspec(noinline)
+#else
+#define ASTEROID_NOINLINE __attribute__((noinline))
+#endif
+
+namespace Asteroid { 
+    
+    std::atomic<std::uint64_t> heapAllocations(0); // every operator new call
+    
+    // all the operators below allocate and free through these two, they are kept out of line so the compiler never
+    // pairs an inlined malloc with a free of a new expression; an (alignment) of 0 is the default alignment, a larger
+    // block keeps the pointer malloc returned just before the aligned address
+    ASTEROID_NOINLINE void* countedAlloc(std::size_t size, std::size_t alignment) noexcept {
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0){ size = 1; }
+        if (alignment == 0){ return std::malloc(size); }
+        void *raw = std::malloc(size + alignment + sizeof(void *));
+        if (raw == nullptr){ return nullptr; }
+        std::uintptr_t at = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *) + alignment - 1) & ~(alignment - 1);
+        reinterpret_cast<void **>(at)[-1] = raw;
+        return reinterpret_cast<void *>(at);
+    }
+    ASTEROID_NOINLINE void countedFree(void *memory, std::size_t alignment) noexcept {
+        if (memory == nullptr){ return; }
+        std::free((alignment == 0)? memory : static_cast<void **>(memory)[-1]);
+    }
+    inline void* countedNew(std::size_t size, std::size_t alignment){
+        if (void *memory = countedAlloc(size, alignment)){ return memory; }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size){ return Asteroid::countedNew(size, 0); }
+void* operator new[](std::size_t size){ return Asteroid::countedNew(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t &) noexcept { return Asteroid::countedAlloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t &) noexcept { return Asteroid::countedAlloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align){ return Asteroid::countedNew(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align){ return Asteroid::countedNew(size, static_cast<std::size_t>(align)); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { 
+    return Asteroid::countedAlloc(size, static_cast<std::size_t>(align)); 
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { 
+    return Asteroid::countedAlloc(size, static_cast<std::size_t>(align)); 
+}
+void operator delete(void *memory) noexcept { Asteroid::countedFree(memory, 0); }
+void operator delete[](void *memory) noexcept { Asteroid::countedFree(memory, 0); }
+void operator delete(void *memory, std::size_t) noexcept { Asteroid::countedFree(memory, 0); }
+void operator delete[](void *memory, std::size_t) noexcept { Asteroid::countedFree(memory, 0); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { Asteroid::countedFree(memory, 0); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { Asteroid::countedFree(memory, 0); }
+void operator delete(void *memory, std::align_val_t align) noexcept { Asteroid::countedFree(memory, static_cast<std::size_t>(align)); }
+void operator delete[](void *memory, std::align_val_t align) noexcept { Asteroid::countedFree(memory, static_cast<std::size_t>(align)); }
+void operator delete(void *memory, std::size_t, std::align_val_t align) noexcept { Asteroid::countedFree(memory, static_cast<std::size_t>(align)); }
+void operator delete[](void *memory, std::size_t, std::align_val_t align) noexcept { Asteroid::countedFree(memory, static_cast<std::size_t>(align)); }
+void operator delete(void *memory, std::align_val_t align, const std::nothrow_t &) noexcept { 
+    Asteroid::countedFree(memory, static_cast<std::size_t>(align)); 
+}
+void operator delete[](void *memory, std::align_val_t align, const std::nothrow_t &) noexcept { 
+    Asteroid::countedFree(memory, static_cast<std::size_t>(align)); 
+}
+#endif
 
 
 namespace Asteroid { 
     
-    sf::Texture imgBack;
+    float screenW = 1280.0F, screenH = 800.0F; // size of the window, the size of the backgrounds
+    float worldW = 1280.0F, worldH = 800.0F;   // size of the playfield, the objects wrap around at its edges
+    int worldScreens = 1;                      // a large world is (worldScreens x worldScreens) screens, the camera follows the ship
     short int fireType = 1, ith_background = 0;
-    bool inHomePage = true, spaceshipBoost = false;
+    bool inHomePage = true, spaceshipBoost = false, showDebugStats = false;
     constexpr auto DEG_TO_RAD = 0.017453F;
     
-    // for generate random number
-    std::mt19937 randGen(static_cast<unsigned>(std::time(nullptr)));
+    // the per tick movement constants were tuned for 120 updates per second, when the simulation runs
+    // at another fixed rate each tick is scaled by (tickScale) so the game speed stays the same
+    constexpr auto REFERENCE_RATE = 120.0F;
+    float simulationRate = 120.0F, renderRate = 120.0F, tickScale = 1.0F;
+    
+    // worker threads of the simulation (the main thread is one of them)
+    unsigned int workerThreads = std::max(1U, std::thread::hardware_concurrency());
+    
+    // settings of the headless benchmark build
+    short int benchmarkWaves = 10, waveStep = 5;
+    unsigned int benchmarkScaling = 0, benchmarkNarrowphase = 0;
+    std::uint64_t benchmarkMaxTicks = 5000000;
+    bool randomInputs = false;
+    
+    // for generate random number, every random choice of the simulation comes from (randGen) so the
+    // same seed and the same inputs play the same game
+    std::uint32_t randomSeed = static_cast<std::uint32_t>(std::time(nullptr));
+    bool seedGiven = false;
+    std::mt19937 randGen(randomSeed);
+    std::string recordFile, replayFile; // record the inputs of the ticks to a file, or play a recording back
+    std::string scenarioFile;           // a spawn schedule played instead of (or before) the normal waves
+    std::string saveFile = "AsteroidSave.sav", resumeFile; // the game is suspended to (saveFile), a run can start from (resumeFile)
+    std::uint64_t saveAtTick = 0;       // the benchmark writes a checkpoint to (saveFile) after this tick (0 = never)
+    unsigned short spectatorPort = 0;   // the game streams to a spectator on this UDP port (0 = off), the spectator build watches it
+    std::string spectatorHost = "127.0.0.1";
+    std::string traceFile;              // the profiler timings are written here (ASTEROID_PROFILE builds)
+    bool showProfiler = false;
+    std::size_t textureBudgetMB = 96;   // the textures are kept within this memory (the sprites are always kept)
+    bool lowResExplosions = false;      // keep the ship explosion sheet at half resolution
+    unsigned int particleBudget = 1024; // explosion particles spawned per tick at most
+    unsigned int huntersPerWave = 0;    // each wave brings (huntersPerWave x wave no.) hunters chasing the ship
     std::uniform_int_distribution<> randNo(0, 1000);
     void loadInitialImage(sf::Texture &, sf::RenderWindow &);
     void gameMessage(sf::String &&, short int, sf::RenderWindow &);
+    void gameDebugStats(sf::String &&, sf::RenderWindow &, float = 40.0F);
+    void parseOptions(int, char *[]);
+    void finishProfile();
     std::string getGameScore(std::string &&);
     void setGameScores(std::string &&, std::string &&);
     
     
-    /////////////////////////////// @c ANIMATION-CLASS //////////////////////////////
+    /////////////////////////////// @c ANIMATION-CLIP-CLASS //////////////////////////////
+    
+    
+    class AnimationClip { // the read only part of an animation, shared by all the objects playing it
+        
+        private : 
+        
+        const sf::Texture *texture;      // the image containing the frames
+        std::vector<sf::IntRect> frames; // this just stores the cords of frames
+        sf::Vector2f origin;             // center of a frame, the objects rotate around it
+        float frameRate, scale;
+        /*
+        imgTobeAnimate : image which contains different view frames in a linear row
+        cordX, cordY   : the inital co-ordinates for the frames
+        frameW, frameH : each frame size
+        frameCount     : total how many frames possible in the image
+        frameRate      : determines the speed of frame changing
+        downscale      : the image is kept at 1/downscale of the sheet size, (scale) draws it at the full size
+        
+        a object playing the clip only keeps the clip id and its own playhead (the current frame)
+        */
+        public : 
+        
+        AnimationClip(const sf::Texture &imgTobeAnimate, int cordX, int cordY, 
+                int frameW, int frameH, int frameCount, float frameSpeed, int downscale = 1) noexcept {
+            
+            frameRate = frameSpeed; // set the frame changing speed
+            scale = downscale;
+            cordX /= downscale;  cordY /= downscale;  frameW /= downscale;  frameH /= downscale;
+            for (short int i = 0; i < frameCount; ++i){
+                frames.push_back(sf::IntRect(cordX + i*frameW, cordY, frameW, frameH));
+                // cordX + frameW * i = goto the next frame(frame cordX = frame size * frame no.)
+            }
+            texture = &imgTobeAnimate;
+            origin = sf::Vector2f(frameW / 2, frameH / 2); // set orgin for smooth rotations for rotable objects
+        }
+        // a clip whose frames are anywhere on the image, like the frames packed into a texture atlas
+        AnimationClip(const sf::Texture &image, std::vector<sf::IntRect> &&frameRects, float frameSpeed) noexcept {
+            frameRate = frameSpeed;   frames = std::move(frameRects);   texture = &image;   scale = 1.0F;
+            origin = sf::Vector2f(frames.front().width / 2, frames.front().height / 2);
+        }
+        AnimationClip() noexcept { texture = nullptr;  frameRate = 0;  scale = 1.0F; }
+        ~AnimationClip() noexcept {}
+        
+        // moves a playhead forward, (step) is the length of the tick, 1 means one frame at the reference rate
+        inline float advance(float playhead, float step = 1.0F) const {
+            playhead += frameRate * step; // increment the frames in timely manner
+            // if the current frame reach to the last then restart
+            if (playhead >= frames.size()){ playhead -= frames.size(); }
+            return playhead;
+        }
+        // checks if the animations is over or not
+        // if the playhead reached the last frame then animation over
+        inline bool isEnd(float playhead, float step = 1.0F) const { return (playhead + frameRate * step  >=  frames.size()); }
+        
+        inline const sf::IntRect& frameAt(float playhead) const { return frames[static_cast<std::size_t>(playhead)]; }
+        inline const sf::Texture* getTexture() const { return texture; }
+        inline const sf::Vector2f& getOrigin() const { return origin; }
+        inline float getScale() const { return scale; }
+        inline std::size_t getFrameCount() const { return frames.size(); }
+    };
+    
+    
+    ////////////////////////////////// @c SPRITE-SHEETS //////////////////////////////////
+    
+    
+    enum AnimationId : std::uint8_t { 
+        SPACESHIP_ANIM, SPACESHIP_BOOST_ANIM, BLUE_BULLET_ANIM, RED_BULLET_ANIM, BIG_ASTEROID_ANIM, 
+        SMALL_ASTEROID_ANIM, SHIP_EXPLOSION_ANIM, HUNTER_ANIM, ANIMATION_COUNT 
+    };
+    
+    struct SpriteSheet { const char *file;  int cordX, cordY, frameW, frameH, frameCount;  float frameSpeed; };
+    
+    // the image and the frame layout of each animation clip (see the AnimationClip constructor)
+    const SpriteSheet SPRITE_SHEETS[ANIMATION_COUNT] = {
+        { "Images/Asteroid/spaceship2.png",  0, 0,  45,  50,  1, 1 },
+        { "Images/Asteroid/spaceship2_.png", 0, 0,  45,  70,  1, 1 },
+        { "Images/Asteroid/bluefire.png",    0, 0,  32,  64, 16, 1 },
+        { "Images/Asteroid/redfire.png",     0, 0,  32,  64, 16, 0 },
+        { "Images/Asteroid/bigrocks.png",    0, 0,  64,  64, 16, 0 },
+        { "Images/Asteroid/smallrocks.png",  0, 0,  64,  64, 16, 0 },
+        { "Images/Asteroid/explosion3.png",  0, 0, 256, 256, 48, 1 },
+        { "Images/Asteroid/spaceship2.png",  0, 0,  45,  50,  1, 1 }  // the hunters fly the spaceship, tinted
+    };
+    
+    // the color multiplied with the frames of a clip
+    inline sf::Color clipTint(std::uint8_t clip){ return (clip == HUNTER_ANIM)? sf::Color(255, 110, 90) : sf::Color::White; }
+    
+    // creates the clip of every sprite sheet, (textures) holds the loaded image of each sheet
+    void createAnimationClips(const sf::Texture *textures, AnimationClip *clips){
+        for (short int i = 0; i < ANIMATION_COUNT; ++i){
+            const SpriteSheet &sheet = SPRITE_SHEETS[i];
+            clips[i] = AnimationClip(textures[i], sheet.cordX, sheet.cordY, 
+                                        sheet.frameW, sheet.frameH, sheet.frameCount, sheet.frameSpeed);
+        }
+    }
+    
+    
+    ////////////////////////////////// @c TEXTURE-ATLAS //////////////////////////////////
+    
+    
+    struct AtlasFrame { std::uint8_t page;  sf::IntRect rect; };
+    
+    class TextureAtlas { // the sprite sheets packed into a few pages by Tools/AtlasPacker.cpp
+        
+        private : 
+        
+        static constexpr std::size_t MAX_PAGES = 8;
+        sf::Texture pages[MAX_PAGES];
+        std::size_t pageCount;
+        std::vector<std::string> sheetFiles;
+        std::vector<std::vector<AtlasFrame>> sheetFrames;
+        /*
+        pages       : the atlas textures, the whole game draws its sprites from these few textures
+        sheetFiles  : the packed sprite sheets, (sheetFrames) holds where each frame of a sheet was put
+        
+        table file  : "asteroid-atlas 1", "pages N" and the N page images, then for each sheet
+                      "sheet <file> <frameW> <frameH> <frameCount>" followed by one "<page> <x> <y>" per frame
+        */
+        public : 
+        
+        TextureAtlas() noexcept { pageCount = 0; }
+        ~TextureAtlas() noexcept {}
+        
+        // reads the frame table and loads the pages, returns false when the atlas was not built
+        bool load(const std::string &tableFile){
+            std::ifstream table(tableFile);
+            std::string word;  int version = 0;
+            if (not (table >> word >> version)  or  word != "asteroid-atlas"  or  version != 1){ return false; }
+            if (not (table >> word >> pageCount)  or  word != "pages"  or  pageCount == 0  or  pageCount > MAX_PAGES){ return false; }
+            
+            for (std::size_t p = 0; p < pageCount; ++p){
+                if (not (table >> word)  or  not pages[p].loadFromFile(word)){ return false; }
+                pages[p].setSmooth(true); // the packer leaves a gap around every frame for the filtering
+            }
+            std::string file;  int frameW, frameH, frameCount;
+            while (table >> word >> file >> frameW >> frameH >> frameCount  and  word == "sheet"){
+                std::vector<AtlasFrame> frames(frameCount);
+                for (auto &frame : frames){
+                    int page, x, y;
+                    if (not (table >> page >> x >> y)  or  page < 0  or  page >= static_cast<int>(pageCount)){ return false; }
+                    frame = AtlasFrame{ static_cast<std::uint8_t>(page), sf::IntRect(x, y, frameW, frameH) };
+                }
+                sheetFiles.push_back(file);  sheetFrames.push_back(std::move(frames));
+            }
+            return not sheetFiles.empty();
+        }
+        
+        // the packed frames of a sheet, nullptr when the sheet is not in the atlas
+        const std::vector<AtlasFrame>* find(const std::string &file) const {
+            for (std::size_t s = 0; s < sheetFiles.size(); ++s){ if (sheetFiles[s] == file){ return &sheetFrames[s]; } }
+            return nullptr;
+        }
+        inline const sf::Texture& getPage(std::size_t page) const { return pages[page]; }
+        inline std::size_t getPageCount() const { return pageCount; }
+        std::size_t getBytes() const {
+            std::size_t bytes = 0;
+            for (std::size_t p = 0; p < pageCount; ++p){ bytes += static_cast<std::size_t>(pages[p].getSize().x) * pages[p].getSize().y * 4; }
+            return bytes;
+        }
+    };
+    
+    // creates the clip of every sprite sheet from the atlas, returns false if a sheet is missing or its
+    // frames do not match SPRITE_SHEETS (an atlas built for other images), then the sheets are used
+    bool createAtlasClips(const TextureAtlas &atlas, AnimationClip *clips){
+        for (short int i = 0; i < ANIMATION_COUNT; ++i){
+            const SpriteSheet &sheet = SPRITE_SHEETS[i];
+            const std::vector<AtlasFrame> *frames = atlas.find(sheet.file);
+            if (frames == nullptr  or  static_cast<int>(frames->size()) != sheet.frameCount){ return false; }
+            
+            std::vector<sf::IntRect> rects;
+            for (const auto &frame : *frames){
+                // an animation draws from one texture, so all the frames of a sheet are on one page
+                if (frame.page != frames->front().page  or  frame.rect.width != sheet.frameW  or  frame.rect.height != sheet.frameH){ 
+                    return false; 
+                }
+                rects.push_back(frame.rect);
+            }
+            clips[i] = AnimationClip(atlas.getPage(frames->front().page), std::move(rects), sheet.frameSpeed);
+        }
+        return true;
+    }
+    
+    
+    //////////////////////////////////// @c SAVE-BUFFERS //////////////////////////////////
+    
+    
+    // a saved session (little endian, the float layout of the machine) : the magic "ASTS", the version byte, 
+    // the SessionHeader fields, the state of the random numbers, then the World, its EntityStore and its
+    // ParticleSystem, its ChunkGrid and its FlowField, each writes its counters and its arrays as whole blocks; a
+    // struct with padding between its fields is written field by field by its fields(), so a save never holds
+    // uninitialised bytes and two saves of the same state are the same bytes
+    const char SAVE_MAGIC[4] = { 'A', 'S', 'T', 'S' };
+    // 2 : the sleeping asteroids of the chunks, 3 : the hunters and the flow field, 4 : the timers, 
+    // 5 : the structs with padding are saved field by field, 6 : the hunters per wave, 7 : the asteroid hit shapes
+    const std::uint8_t SAVE_VERSION = 7;
+    
+    // counts the bytes the fields() of a struct save, the smallest size of a saved element
+    struct FieldBytes { std::size_t bytes = 0;  template <typename T> void field(const T &){ bytes += sizeof(T); } };
+    template <typename T> std::size_t savedBytes(){ FieldBytes counter;  const T probe{};  T::fields(counter, probe);  return counter.bytes; }
+    
+    class SaveWriter { // collects a save in memory, so the file is written with one call
+        
+        private : 
+        
+        std::vector<char> bytes;
+        
+        public : 
+        
+        SaveWriter() noexcept {}
+        ~SaveWriter() noexcept {}
+        
+        template <typename T> void field(const T &value){ array(&value, 1); }
+        template <typename T> void array(const T *data, std::size_t count){
+            static_assert(std::is_trivially_copyable<T>::value, "only plain data is saved as bytes");
+            if (count == 0){ return; }
+            const char *from = reinterpret_cast<const char *>(data);
+            bytes.insert(bytes.end(), from, from + count * sizeof(T));
+        }
+        // the length and the elements of a vector
+        template <typename T> void vector(const std::vector<T> &values){ 
+            field(static_cast<std::uint64_t>(values.size()));   array(values.data(), values.size()); 
+        }
+        // the length and the elements of a vector of structs, each written by T::fields
+        template <typename T> void records(const std::vector<T> &values){ 
+            field(static_cast<std::uint64_t>(values.size()));
+            for (const auto &value : values){ T::fields(*this, value); }
+        }
+        inline const std::vector<char>& getBytes() const { return bytes; }
+    };
+    
+    class SaveReader { // reads a save from memory, reading past its end only sets (failed)
+        
+        private : 
+        
+        const char *at, *end;
+        bool failed;
+        
+        public : 
+        
+        SaveReader(const char *data, std::size_t size) noexcept { at = data;  end = data + size;  failed = false; }
+        ~SaveReader() noexcept {}
+        
+        inline std::size_t remaining() const { return end - at; }
+        inline bool isValid() const { return not failed; }
+        inline void fail(){ failed = true; }
+        
+        template <typename T> void field(T &value){ array(&value, 1); }
+        template <typename T> void array(T *data, std::size_t count){
+            static_assert(std::is_trivially_copyable<T>::value, "only plain data is saved as bytes");
+            if (failed  or  count > remaining() / sizeof(T)){ failed = true;  return; }
+            if (count == 0){ return; }
+            std::memcpy(data, at, count * sizeof(T));
+            at += count * sizeof(T);
+        }
+        // a length, which is checked against the bytes left before anything is allocated for it
+        std::size_t count(std::size_t elementBytes){
+            std::uint64_t length = 0;
+            field(length);
+            if (failed  or  length > remaining() / std::max<std::size_t>(elementBytes, 1)){ failed = true;  return 0; }
+            return static_cast<std::size_t>(length);
+        }
+        template <typename T> void vector(std::vector<T> &values){ 
+            values.resize(count(sizeof(T)));   array(values.data(), values.size()); 
+        }
+        template <typename T> void records(std::vector<T> &values){ 
+            values.resize(count(savedBytes<T>()));
+            for (auto &value : values){ T::fields(*this, value); }
+        }
+    };
+    
+    
+    //////////////////////////////////// @c ENTITY-STORE //////////////////////////////////
+    
+    
+    // integer type tags for the game objects (compared instead of names)
+    enum EntityType : std::uint8_t { SPACESHIP, BULLET, ASTEROID, EXPLOSION, HUNTER, ENTITY_TYPES };
+    
+    // a stable reference to a entity, it remains valid while the entity moves around inside its pool
+    // and becomes stale (generation mismatch) once the entity is removed, the default handle is no entity
+    struct EntityHandle { std::uint32_t slot = UINT32_MAX, generation = 0; };
+    
+    
+    class EntityPool { // all the entities of one type, stored as a structure of arrays
+        
+        public : 
+        
+        std::vector<float> x, y, dx, dy, angle, R;
+        std::vector<float> prevX, prevY, prevAngle;
+        std::vector<std::uint8_t> life, split;
+        std::vector<std::uint8_t> clip;
+        std::vector<float> playhead;
+        std::vector<std::uint32_t> handleSlot;
+        std::size_t count;
+        /*
+        x , y        : current co-ordinates of the entities
+        dx , dy      : velocity of the entities (added to the co-ordinates on each update)
+        angle        : a angle in which direction the entity is moving
+        R            : radious of the entity for the collision detections
+        prev...      : the state before the last tick, used to interpolate the drawing between two ticks
+        life         : that defines the entity is collided and alive or not
+        split        : marks a asteroid that has to break into small asteroids
+        clip         : the AnimationId of the clip each entity plays
+        playhead     : the current frame of each entity inside its clip (fractional between frames)
+        handleSlot   : the slot of each entity inside the handle table of the store
+        count        : the live entities are [0, count), the arrays always hold the full capacity and
+                       the slots after (count) are dead entities waiting to be recycled
+        */
+        EntityPool() noexcept { count = 0; }
+        ~EntityPool() noexcept {}
+        
+        inline std::size_t size() const { return count; }
+        inline std::size_t capacity() const { return x.size(); }
+        
+        // allocates every slot up front
+        void reserve(std::size_t maxEntities){
+            for (auto *field : { &x, &y, &dx, &dy, &angle, &R, &prevX, &prevY, &prevAngle, &playhead }){ 
+                field->resize(maxEntities); 
+            }
+            life.resize(maxEntities);   split.resize(maxEntities);   clip.resize(maxEntities);
+            handleSlot.resize(maxEntities);
+        }
+    };
+    
+    
+    class EntityStore { // owns one pool per entity type and the handle table
+        
+        private : 
+        
+        struct HandleEntry { 
+            std::uint32_t generation, index;  EntityType type; 
+            // the saved fields (Stream is a SaveWriter or a SaveReader)
+            template <typename Stream, typename Self> static void fields(Stream &io, Self &e){ io.field(e.generation);  io.field(e.index);  io.field(e.type); }
+        };
+        
+        EntityPool pools[ENTITY_TYPES];
+        std::vector<HandleEntry> handles;
+        std::vector<std::uint32_t> freeSlots; // released slots of the handle table for reuse
+        unsigned long spawnsDropped;          // spawns refused because the pool was full
+        
+        public : 
+        
+        EntityStore() noexcept { spawnsDropped = 0; }
+        ~EntityStore() noexcept {}
+        
+        inline EntityPool& operator[](EntityType type){ return pools[type]; }
+        inline const EntityPool& operator[](EntityType type) const { return pools[type]; }
+        inline std::size_t indexOf(EntityHandle h) const { return handles[h.slot].index; }
+        inline std::uint32_t generationOf(std::uint32_t slot) const { return handles[slot].generation; }
+        inline bool isValid(EntityHandle h) const { 
+            return h.slot < handles.size()  and  handles[h.slot].generation == h.generation; 
+        }
+        // marks the entity of a valid handle dead, removeDead takes it out of its pool
+        inline void kill(EntityHandle h){ pools[handles[h.slot].type].life[handles[h.slot].index] = false; }
+        inline unsigned long getSpawnsDropped() const { return spawnsDropped; }
+        std::size_t count() const { // total entities of all types
+            std::size_t total = 0;
+            for (auto &pool : pools){ total += pool.size(); }
+            return total;
+        }
+        
+        // set the fixed capacity of a pool, the handle table grows to cover all the pools
+        void reserve(EntityType type, std::size_t maxEntities){
+            pools[type].reserve(maxEntities);
+            std::size_t total = 0;
+            for (auto &pool : pools){ total += pool.capacity(); }
+            handles.reserve(total);  freeSlots.reserve(total);
+        }
+        
+        EntityHandle spawn(EntityType type, AnimationId anim, float X, float Y, 
+                            float degree = 1, float radious = 0, float velX = 0, float velY = 0){
+            
+            EntityPool &pool = pools[type];
+            if (pool.count == pool.capacity()){ ++spawnsDropped;  return EntityHandle(); }
+            
+            std::uint32_t slot;
+            if (not freeSlots.empty()){ slot = freeSlots.back();  freeSlots.pop_back(); }
+            else { slot = handles.size();  handles.push_back(HandleEntry{ 0, 0, type }); }
+            
+            std::size_t i = pool.count++; // recycle the first dead slot of the pool
+            handles[slot].index = i;  handles[slot].type = type;
+            
+            pool.x[i]     = pool.prevX[i] = X;          pool.y[i]  = pool.prevY[i] = Y;
+            pool.angle[i] = pool.prevAngle[i] = degree; pool.R[i]  = radious;
+            pool.dx[i]    = velX;                       pool.dy[i] = velY;
+            pool.life[i]  = true;                       pool.split[i] = false;
+            pool.clip[i]  = anim;                       pool.playhead[i] = 0.0F; // start from the first most frame
+            pool.handleSlot[i] = slot;
+            return EntityHandle{ slot, handles[slot].generation };
+        }
+        
+        // removes every entity and forgets the handles, the capacities stay
+        void clear(){
+            for (auto &pool : pools){ pool.count = 0; }
+            handles.clear();   freeSlots.clear();   spawnsDropped = 0;
+        }
+        
+        // the handle table and the live part of every pool array
+        void save(SaveWriter &out) const {
+            out.field(static_cast<std::uint64_t>(spawnsDropped));
+            out.records(handles);   out.vector(freeSlots);
+            for (const auto &pool : pools){
+                out.field(static_cast<std::uint64_t>(pool.count));
+                for (auto *field : { &pool.x, &pool.y, &pool.dx, &pool.dy, &pool.angle, &pool.R, 
+                                     &pool.prevX, &pool.prevY, &pool.prevAngle, &pool.playhead }){ 
+                    out.array(field->data(), pool.count); 
+                }
+                out.array(pool.life.data(), pool.count);    out.array(pool.split.data(), pool.count);
+                out.array(pool.clip.data(), pool.count);    out.array(pool.handleSlot.data(), pool.count);
+            }
+        }
+        // a pool with more saved entities than its capacity grows, returns false for a broken save
+        // (the store is left empty then)
+        bool load(SaveReader &in){
+            std::uint64_t dropped = 0;
+            in.field(dropped);   spawnsDropped = static_cast<unsigned long>(dropped);
+            in.records(handles);   in.vector(freeSlots);
+            const std::size_t entityBytes = 10 * sizeof(float) + 3 + sizeof(std::uint32_t);
+            for (int type = 0; type < ENTITY_TYPES  and  in.isValid(); ++type){
+                EntityPool &pool = pools[type];
+                std::size_t count = in.count(entityBytes);
+                if (count > pool.capacity()){ reserve(static_cast<EntityType>(type), count); }
+                pool.count = count;
+                for (auto *field : { &pool.x, &pool.y, &pool.dx, &pool.dy, &pool.angle, &pool.R, 
+                                     &pool.prevX, &pool.prevY, &pool.prevAngle, &pool.playhead }){ 
+                    in.array(field->data(), count); 
+                }
+                in.array(pool.life.data(), count);    in.array(pool.split.data(), count);
+                in.array(pool.clip.data(), count);    in.array(pool.handleSlot.data(), count);
+                
+                // every entity has to own its handle, and play a clip which exists
+                for (std::size_t i = 0; i < count  and  in.isValid(); ++i){
+                    std::uint32_t slot = pool.handleSlot[i];
+                    if (slot >= handles.size()  or  handles[slot].index != i  or  handles[slot].type != type  
+                        or  pool.clip[i] >= ANIMATION_COUNT){ in.fail(); }
+                }
+            }
+            for (auto slot : freeSlots){ if (slot >= handles.size()){ in.fail(); } }
+            if (not in.isValid()){ clear();  return false; }
+            
+            std::size_t total = 0;
+            for (auto &pool : pools){ total += pool.capacity(); }
+            handles.reserve(std::max(total, handles.size()));   freeSlots.reserve(std::max(total, handles.size()));
+            return true;
+        }
+        
+        // remove the dead entities of a pool, the last entity is moved into the hole (swap and pop)
+        void removeDead(EntityType type){
+            
+            EntityPool &pool = pools[type];
+            for (std::size_t i = 0; i < pool.count; ){
+                if (pool.life[i]){ ++i;  continue; }
+                
+                // invalidate the handles of the removed entity and recycle its slot
+                ++handles[pool.handleSlot[i]].generation;
+                freeSlots.push_back(pool.handleSlot[i]);
+                
+                std::size_t last = --pool.count;
+                if (i != last){
+                    pool.x[i]     = pool.x[last];       pool.y[i]     = pool.y[last];
+                    pool.dx[i]    = pool.dx[last];      pool.dy[i]    = pool.dy[last];
+                    pool.angle[i] = pool.angle[last];   pool.R[i]     = pool.R[last];
+                    pool.prevX[i] = pool.prevX[last];   pool.prevY[i] = pool.prevY[last];
+                    pool.prevAngle[i] = pool.prevAngle[last];
+                    pool.life[i]  = pool.life[last];    pool.split[i] = pool.split[last];
+                    pool.clip[i]  = pool.clip[last];    pool.playhead[i] = pool.playhead[last];
+                    pool.handleSlot[i] = pool.handleSlot[last];
+                    handles[pool.handleSlot[i]].index = i;
+                }
+            }
+        }
+    };
+
+    
+    
+    ////////////////////////////////// @c TRIG-TABLE-AND-SIMD-LANES //////////////////////////////////
+    
+    
+    // sine of (TRIG_STEPS) angles over a full turn, the cosine is the sine a quarter turn later
+    constexpr int TRIG_STEPS = 4096, TRIG_MASK = TRIG_STEPS - 1;
+    constexpr float TRIG_STEPS_PER_DEGREE = TRIG_STEPS / 360.0F;
+    
+    struct TrigTable { 
+        float sine[TRIG_STEPS]; 
+        TrigTable() noexcept { 
+            for (int i = 0; i < TRIG_STEPS; ++i){ sine[i] = static_cast<float>(std::sin(i * 6.283185307179586 / TRIG_STEPS)); } 
+        }
+    };
+    const TrigTable trigTable;
+    
+    // the table index of the nearest step to (degree), the rounding is the same as the vector conversion
+    inline int trigIndex(float degree){ return static_cast<int>(std::lrint(degree * TRIG_STEPS_PER_DEGREE)) & TRIG_MASK; }
+    inline float tableSin(float degree){ return trigTable.sine[trigIndex(degree)]; }
+    inline float tableCos(float degree){ return trigTable.sine[(trigIndex(degree) + TRIG_STEPS / 4) & TRIG_MASK]; }
+    
+    // (FloatLanes) holds one float of (LANES) entities, the kernels below use only these helpers so the
+    // same kernel builds for AVX2, SSE2 or (ASTEROID_NO_SIMD) the plain scalar loop
+#if defined(__AVX2__)  and  not defined(ASTEROID_NO_SIMD)
+#define ASTEROID_SIMD
+    using FloatLanes = __m256;
+    constexpr std::size_t LANES = 8;
+    inline FloatLanes loadLanes(const float *from){ return _mm256_loadu_ps(from); }
+    inline void storeLanes(float *to, FloatLanes v){ _mm256_storeu_ps(to, v); }
+    inline FloatLanes splat(float f){ return _mm256_set1_ps(f); }
+    inline FloatLanes add(FloatLanes a, FloatLanes b){ return _mm256_add_ps(a, b); }
+    inline FloatLanes sub(FloatLanes a, FloatLanes b){ return _mm256_sub_ps(a, b); }
+    inline FloatLanes mul(FloatLanes a, FloatLanes b){ return _mm256_mul_ps(a, b); }
+    inline FloatLanes divide(FloatLanes a, FloatLanes b){ return _mm256_div_ps(a, b); }
+    inline FloatLanes lessThan(FloatLanes a, FloatLanes b){ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline FloatLanes either(FloatLanes mask1, FloatLanes mask2){ return _mm256_or_ps(mask1, mask2); }
+    inline FloatLanes select(FloatLanes mask, FloatLanes ifTrue, FloatLanes ifFalse){ return _mm256_blendv_ps(ifFalse, ifTrue, mask); }
+    inline int maskBits(FloatLanes mask){ return _mm256_movemask_ps(mask); }
+    inline void sinCosLanes(FloatLanes degree, FloatLanes &sine, FloatLanes &cosine){
+        __m256i index = _mm256_and_si256(_mm256_cvtps_epi32(mul(degree, splat(TRIG_STEPS_PER_DEGREE))), _mm256_set1_epi32(TRIG_MASK));
+        sine   = _mm256_i32gather_ps(trigTable.sine, index, 4);
+        cosine = _mm256_i32gather_ps(trigTable.sine, _mm256_and_si256(_mm256_add_epi32(index, _mm256_set1_epi32(TRIG_STEPS / 4)), 
+                                                                      _mm256_set1_epi32(TRIG_MASK)), 4);
+    }
+#elif defined(__SSE2__)  and  not defined(ASTEROID_NO_SIMD)
+#define ASTEROID_SIMD
+    using FloatLanes = __m128;
+    constexpr std::size_t LANES = 4;
+    inline FloatLanes loadLanes(const float *from){ return _mm_loadu_ps(from); }
+    inline void storeLanes(float *to, FloatLanes v){ _mm_storeu_ps(to, v); }
+    inline FloatLanes splat(float f){ return _mm_set1_ps(f); }
+    inline FloatLanes add(FloatLanes a, FloatLanes b){ return _mm_add_ps(a, b); }
+    inline FloatLanes sub(FloatLanes a, FloatLanes b){ return _mm_sub_ps(a, b); }
+    inline FloatLanes mul(FloatLanes a, FloatLanes b){ return _mm_mul_ps(a, b); }
+    inline FloatLanes divide(FloatLanes a, FloatLanes b){ return _mm_div_ps(a, b); }
+    inline FloatLanes lessThan(FloatLanes a, FloatLanes b){ return _mm_cmplt_ps(a, b); }
+    inline FloatLanes either(FloatLanes mask1, FloatLanes mask2){ return _mm_or_ps(mask1, mask2); }
+    inline FloatLanes select(FloatLanes mask, FloatLanes ifTrue, FloatLanes ifFalse){ 
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse)); 
+    }
+    inline int maskBits(FloatLanes mask){ return _mm_movemask_ps(mask); }
+    inline void sinCosLanes(FloatLanes degree, FloatLanes &sine, FloatLanes &cosine){ // SSE2 has no gather
+        alignas(16) std::int32_t index[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(index), _mm_and_si128(_mm_cvtps_epi32(mul(degree, splat(TRIG_STEPS_PER_DEGREE))), 
+                                                                          _mm_set1_epi32(TRIG_MASK)));
+        const float *table = trigTable.sine;
+        const int quarter = TRIG_STEPS / 4;
+        sine   = _mm_setr_ps(table[index[0]], table[index[1]], table[index[2]], table[index[3]]);
+        cosine = _mm_setr_ps(table[(index[0] + quarter) & TRIG_MASK], table[(index[1] + quarter) & TRIG_MASK], 
+                             table[(index[2] + quarter) & TRIG_MASK], table[(index[3] + quarter) & TRIG_MASK]);
+    }
+#endif
+    
+    
+    ////////////////////////////////// @c SPACESHIP-UPDATE //////////////////////////////////
+    
+    
+    void updateSpaceShips(EntityPool &ships){
+        
+        const float drag = std::pow(0.99F, tickScale); // 0.99 per reference tick
+        for (std::size_t i = 0; i < ships.size(); ++i){
+            float &x = ships.x[i], &y = ships.y[i], &dx = ships.dx[i], &dy = ships.dy[i], angle = ships.angle[i];
+            
+            if (spaceshipBoost){ // if user boosted the ship by up-arraow then increase speed
+                dx += tableCos(angle) * 0.2F * tickScale;
+                dy += tableSin(angle) * 0.2F * tickScale;
+            }
+            else { dx *= drag;  dy *= drag; } // otherwise decrease the speed gradually
+            
+            // prevent the ship speed to become too much fast
+            float maxSpeed = 5.0F, speed = std::sqrt(dx * dx  +  dy * dy);
+            if (speed > maxSpeed){ dx *= maxSpeed / speed;  dy *= maxSpeed / speed; }
+            
+            x += dx * tickScale;  y += dy * tickScale;
+            
+            // screen wrapping 
+            // if the ship moves off one side of the screen then it reappears on other side
+            if (x < 0.0F){ x = worldW; }
+            if (y < 0.0F){ y = worldH; }
+            if (x > worldW){ x = 0.0F; }
+            if (y > worldH){ y = 0.0F; }
+        }
+    }
+    
+    
+    ////////////////////////////////// @c BULLET-UPDATE //////////////////////////////////
+    
+    
+    // a random number made from its inputs, the same inputs always give the same number on any thread
+    inline std::uint32_t hashNoise(std::uint64_t a, std::uint64_t b){
+        std::uint64_t z = a * 0x9E3779B97F4A7C15ULL + b + 0x632BE59BD9B4E019ULL; // splitmix64
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<std::uint32_t>(z ^ (z >> 31));
+    }
+    
+    // the reference ticks (REFERENCE_RATE) which have passed by the end of (tick), a change made once per reference tick
+    // is made (referenceTicksAt(n) - referenceTicksAt(n - 1)) times in tick n, so it comes as often at any simulation rate
+    inline std::uint64_t referenceTicksAt(std::uint64_t tick){ 
+        return static_cast<std::uint64_t>(tick * (static_cast<double>(REFERENCE_RATE) / simulationRate) + 1e-6); 
+    }
+    
+    // updates the bullets [begin, end), LANES bullets at a time, the bullets going out of the screen are
+    // marked dead with a mask instead of a branch, the spread of the special fire is taken from (hashNoise)
+    // of the tick and the bullet so the batches can run on any thread in any order
+    void updateBullets(EntityPool &bullets, std::size_t begin, std::size_t end, std::uint64_t tickNo){
+        
+        float *x = bullets.x.data(), *y = bullets.y.data(), *dx = bullets.dx.data(), *dy = bullets.dy.data();
+        const float *angle = bullets.angle.data();
+        std::uint8_t *life = bullets.life.data();
+        std::size_t i = begin;
+#ifdef ASTEROID_SIMD
+        const FloatLanes scale = splat(tickScale), halfScale = splat(0.5F * tickScale), zero = splat(0.0F), right = splat(worldW), bottom = splat(worldH);
+        for (; i + LANES <= end; i += LANES){
+            FloatLanes sine, cosine;
+            sinCosLanes(loadLanes(angle + i), sine, cosine);
+            FloatLanes oldX = loadLanes(dx + i), oldY = loadLanes(dy + i);
+            FloatLanes velX = add(oldX, mul(cosine, scale)), velY = add(oldY, mul(sine, scale));
+            FloatLanes posX = add(loadLanes(x + i), mul(add(oldX, velX), halfScale)), posY = add(loadLanes(y + i), mul(add(oldY, velY), halfScale));
+            storeLanes(dx + i, velX);   storeLanes(dy + i, velY);
+            storeLanes(x + i, posX);    storeLanes(y + i, posY);
+            
+            int outside = maskBits(either(either(lessThan(posX, zero), lessThan(right, posX)), 
+                                          either(lessThan(posY, zero), lessThan(bottom, posY))));
+            for (std::size_t k = 0; k < LANES; ++k){ life[i + k] &= ~(outside >> k) & 1; }
+        }
+#endif
+        for (; i < end; ++i){ // the remaining bullets, the same operations one by one
+            float oldX = dx[i], oldY = dy[i];
+            dx[i] += tableCos(angle[i]) * tickScale;   // calculate the velocity horizontal
+            dy[i] += tableSin(angle[i]) * tickScale;   // calculate the velocity vertically
+            // updae to the actual co-ordinates with the mean velocity of the tick, which is exact for the constant 
+            // acceleration, so a bullet flies the same path at any simulation rate
+            x[i] += (oldX + dx[i]) * (0.5F * tickScale);   y[i] += (oldY + dy[i]) * (0.5F * tickScale);
+            // if go out of bound then remove that bullet
+            life[i] &= not ((x[i] < 0.0F) | (worldW < x[i]) | (y[i] < 0.0F) | (worldH < y[i]));
+        }
+        // change the fire types but not effect the single fire type 
+        if (fireType == 1){ return; }
+        // the special fire turns a bullet at random once per reference tick
+        std::uint64_t firstTurn = referenceTicksAt(tickNo - 1), lastTurn = referenceTicksAt(tickNo);
+        for (i = begin; i < end; ++i){
+            if (bullets.R[i] != 11){ continue; }
+            if (fireType == 2){ bullets.angle[i] += (static_cast<int>(hashNoise(tickNo, i) % 7) - 3) * tickScale; }
+            if (fireType == 3){ for (auto turn = firstTurn; turn < lastTurn; ++turn){ bullets.angle[i] += hashNoise(turn, i) % 1001; } }
+        }
+    }
+    
+    
+    ////////////////////////////////// @c ASTEROID-UPDATE //////////////////////////////////
+    
+    
+    const int ASTEROID_MAX_SPEED = 2; // per axis and reference tick, the broadphase widens its swept queries by it
+    
+    // spawn a asteroid with random velocity, limited to (ASTEROID_MAX_SPEED)
+    EntityHandle spawnAsteroid(EntityStore &store, AnimationId anim, float X, float Y, float degree, float radious){
+        float velX = randNo(randGen) % (ASTEROID_MAX_SPEED + 1), velY = randNo(randGen) % (ASTEROID_MAX_SPEED + 1);
+        return store.spawn(ASTEROID, anim, X, Y, degree, radious, velX, velY);
+    }
+    
+    // moves the asteroids [begin, end) LANES at a time, the screen wrapping is done with masks
+    void updateAsteroids(EntityPool &asteroids, std::size_t begin, std::size_t end){
+        
+        float *x = asteroids.x.data(), *y = asteroids.y.data();
+        const float *dx = asteroids.dx.data(), *dy = asteroids.dy.data();
+        std::size_t i = begin;
+#ifdef ASTEROID_SIMD
+        const FloatLanes scale = splat(tickScale), zero = splat(0.0F), right = splat(worldW), bottom = splat(worldH);
+        for (; i + LANES <= end; i += LANES){
+            FloatLanes posX = add(loadLanes(x + i), mul(loadLanes(dx + i), scale));
+            FloatLanes posY = add(loadLanes(y + i), mul(loadLanes(dy + i), scale));
+            // screen wrapping (same like the spaceship)
+            posX = select(lessThan(posX, zero), right, posX);    posY = select(lessThan(posY, zero), bottom, posY);
+            posX = select(lessThan(right, posX), zero, posX);    posY = select(lessThan(bottom, posY), zero, posY);
+            storeLanes(x + i, posX);    storeLanes(y + i, posY);
+        }
+#endif
+        for (; i < end; ++i){
+            x[i] += dx[i] * tickScale;   y[i] += dy[i] * tickScale; // update the actual co-ordinates
+            x[i] = (x[i] < 0.0F)? worldW : x[i];      y[i] = (y[i] < 0.0F)? worldH : y[i];
+            x[i] = (worldW < x[i])? 0.0F : x[i];      y[i] = (worldH < y[i])? 0.0F : y[i];
+        }
+    }
+    
+    
+    ////////////////////////////////// @c SPRITE-BATCH //////////////////////////////////
+    
+    
+    class SpriteBatch { // collects sprites as quads, and draws all quads of a texture with a single draw call
+        
+        private : 
+        
+        struct Batch { const sf::Texture *texture;  sf::VertexArray quads; };
+        std::vector<Batch> batches;   // one batch per texture (only a few textures, so a linear search)
+        unsigned int spritesAdded, drawCalls;
+        
+        public : 
+        
+        SpriteBatch() noexcept { spritesAdded = drawCalls = 0; }
+        ~SpriteBatch() noexcept {}
+        
+        // counters of the last flush, a sprite drawn one by one would need one draw call each
+        inline unsigned int getSpriteCount() const { return spritesAdded; }
+        inline unsigned int getDrawCalls() const { return drawCalls; }
+        
+        // add a frame (rect) of a texture, rotated by (degree) around its (origin) and placed at (x, y)
+        // (scale) enlarges a frame kept at a reduced resolution back to its size on the screen, (tint) colors it
+        void add(const sf::Texture *texture, const sf::IntRect &rect, const sf::Vector2f &origin, 
+                 float x, float y, float degree, float scale = 1.0F, sf::Color tint = sf::Color::White){
+            
+            Batch *batch = nullptr;
+            for (auto &b : batches){ if (b.texture == texture){ batch = &b;  break; } }
+            if (batch == nullptr){
+                batches.push_back(Batch{ texture, sf::VertexArray(sf::Quads) });
+                batch = &batches.back();
+            }
+            // the corners of the frame, rotated around the origin and moved to the position
+            float cosA = std::cos(degree * DEG_TO_RAD), sinA = std::sin(degree * DEG_TO_RAD);
+            float left = -origin.x * scale, top = -origin.y * scale;
+            float right = left + rect.width * scale, bottom = top + rect.height * scale;
+            auto corner = [&](float cx, float cy){ return sf::Vector2f(x + cx*cosA - cy*sinA, y + cx*sinA + cy*cosA); };
+            
+            float u1 = rect.left, v1 = rect.top, u2 = u1 + rect.width, v2 = v1 + rect.height;
+            batch->quads.append(sf::Vertex(corner(left,  top),    tint, sf::Vector2f(u1, v1)));
+            batch->quads.append(sf::Vertex(corner(right, top),    tint, sf::Vector2f(u2, v1)));
+            batch->quads.append(sf::Vertex(corner(right, bottom), tint, sf::Vector2f(u2, v2)));
+            batch->quads.append(sf::Vertex(corner(left,  bottom), tint, sf::Vector2f(u1, v2)));
+            ++spritesAdded;
+        }
+        
+        void flush(sf::RenderTarget &target){
+            
+            drawCalls = 0;
+            for (auto &batch : batches){
+                if (batch.quads.getVertexCount() == 0){ continue; }
+                target.draw(batch.quads, sf::RenderStates(batch.texture));
+                batch.quads.clear(); // keeps the memory for the next frame
+                ++drawCalls;
+            }
+        }
+        // restart the sprite counter for a new frame
+        inline void begin(){ spritesAdded = 0; }
+    };
+    
+    
+    ////////////////////////////////// @c ANIMATION-UPDATE-AND-DRAW //////////////////////////////////
+    
+    
+    void updateAnimations(EntityPool &pool, const AnimationClip *clips, std::size_t begin, std::size_t end){
+        for (std::size_t i = begin; i < end; ++i){ 
+            pool.playhead[i] = clips[pool.clip[i]].advance(pool.playhead[i], tickScale); 
+        }
+    }
+    
+    // remember the state at the start of a tick, the drawing blends from it to the new state
+    void savePreviousState(EntityPool &pool){
+        std::copy_n(pool.x.begin(), pool.size(), pool.prevX.begin());
+        std::copy_n(pool.y.begin(), pool.size(), pool.prevY.begin());
+        std::copy_n(pool.angle.begin(), pool.size(), pool.prevAngle.begin());
+    }
+    
+    // a jump larger than half the world (span) is a wrap, it is not blended across the world
+    inline float blendWrapped(float previous, float current, float alpha, float span){
+        return (std::abs(current - previous) < span / 2.0F)? previous + (current - previous) * alpha : current;
+    }
+    
+    // for a camera (view) in a large world : moves (x, y) to its copy nearest the camera (the world wraps around),
+    // returns false when that copy is more than (margin) outside of the view
+    inline bool placeInView(const sf::FloatRect &view, float margin, float &x, float &y){
+        float centerX = view.left + view.width / 2.0F, centerY = view.top + view.height / 2.0F;
+        if (x - centerX > worldW / 2.0F){ x -= worldW; }   else if (centerX - x > worldW / 2.0F){ x += worldW; }
+        if (y - centerY > worldH / 2.0F){ y -= worldH; }   else if (centerY - y > worldH / 2.0F){ y += worldH; }
+        return x + margin >= view.left  and  x - margin <= view.left + view.width  
+           and  y + margin >= view.top   and  y - margin <= view.top + view.height;
+    }
+    
+    // (alpha) is how far the render time is between the previous and the current tick (0 - 1), with a camera
+    // (view) only the entities on the screen are drawn
+    void drawEntities(const EntityPool &pool, const AnimationClip *clips, SpriteBatch &batch, float alpha, 
+                        const sf::FloatRect *view = nullptr){
+        
+        for (std::size_t i = 0; i < pool.size(); ++i){
+            float x = blendWrapped(pool.prevX[i], pool.x[i], alpha, worldW);
+            float y = blendWrapped(pool.prevY[i], pool.y[i], alpha, worldH);
+            
+            const AnimationClip &clip = clips[pool.clip[i]];
+            // a frame rotates around its center, so it never reaches further than the corners of the frame
+            if (view != nullptr  and  not placeInView(*view, std::hypot(clip.getOrigin().x, clip.getOrigin().y) * clip.getScale(), x, y)){ 
+                continue; 
+            }
+            float rotation = pool.prevAngle[i] + (pool.angle[i] - pool.prevAngle[i]) * alpha + 90.0F;
+            // add the current frame to the batch
+            batch.add(clip.getTexture(), clip.frameAt(pool.playhead[i]), clip.getOrigin(), x, y, rotation, clip.getScale(), clipTint(pool.clip[i]));
+        }
+    }
+    
+    
+    ////////////////////////////////// @c EXPLOSION-PARTICLES //////////////////////////////////
+    
+    
+    enum ParticleStyleId : std::uint8_t { SMALL_ROCK_BURST, BIG_ROCK_BURST, PARTICLE_STYLE_COUNT };
+    
+    // a burst throws (count) particles in random directions, the speeds are per reference tick, the lifetimes 
+    // in seconds, the color fades from (startColor) to (endColor) and to transparent over the lifetime
+    struct ParticleStyle { 
+        unsigned int count;  float minSpeed, maxSpeed, minLifetime, maxLifetime, size, drag;  sf::Color startColor, endColor; 
+    };
+    const ParticleStyle PARTICLE_STYLES[PARTICLE_STYLE_COUNT] = {
+        { 24, 0.5F, 2.0F, 0.35F, 0.6F, 2.0F, 0.98F, sf::Color(255, 235, 170), sf::Color(200, 60, 20) },
+        { 64, 0.5F, 3.5F, 0.50F, 1.0F, 3.0F, 0.98F, sf::Color(255, 245, 200), sf::Color(170, 40, 10) }
+    };
+    
+    struct Particle { 
+        float x, y, dx, dy, age, lifetime, size;  ParticleStyleId style; 
+        template <typename Stream, typename Self> static void fields(Stream &io, Self &p){
+            io.field(p.x);     io.field(p.y);          io.field(p.dx);     io.field(p.dy);
+            io.field(p.age);   io.field(p.lifetime);   io.field(p.size);   io.field(p.style);
+        }
+    };
+    
+    class ParticleSystem { // the explosions of the asteroids as particles in one buffer, drawn as one vertex array
+        
+        private : 
+        
+        struct Burst { ParticleStyleId style;  float x, y; };
+        
+        std::vector<Particle> particles;
+        std::vector<Burst> pending;
+        unsigned long particlesCut;
+        std::uint32_t burstSerial;
+        /*
+        particles    : the live particles, their memory is reserved once and never grows
+        pending      : the bursts asked for during a tick, they are spawned together by (emit) so the budget 
+                       of a tick is shared by all of them instead of going to the first ones
+        particlesCut : particles not spawned because of the budget or the capacity (a counter for the stats)
+        burstSerial  : numbers the bursts, the random directions are taken from (hashNoise) of it so the 
+                       particles never draw from the game random numbers
+        */
+        public : 
+        
+        ParticleSystem(std::size_t capacity, std::size_t maxBursts) { 
+            particles.reserve(capacity);   pending.reserve(maxBursts);
+            particlesCut = 0;   burstSerial = 0;
+        }
+        ~ParticleSystem() noexcept {}
+        
+        inline std::size_t size() const { return particles.size(); }
+        inline unsigned long getCutCount() const { return particlesCut; }
+        inline void clear(){ particles.clear();  pending.clear(); }
+        
+        // asks for a burst at (x, y), a burst beyond the reserved ones is dropped
+        void burst(ParticleStyleId style, float x, float y){
+            if (pending.size() == pending.capacity()){ particlesCut += PARTICLE_STYLES[style].count;  return; }
+            pending.push_back(Burst{ style, x, y });
+        }
+        
+        // spawns the pending bursts within (budget) particles, when they ask for more every burst is cut by
+        // the same share and its particles are drawn larger, so a chain of kills looks the same but lighter
+        void emit(unsigned int budget){
+            
+            std::size_t wanted = 0;
+            for (const auto &b : pending){ wanted += PARTICLE_STYLES[b.style].count; }
+            std::size_t allowed = std::min<std::size_t>({ wanted, budget, particles.capacity() - particles.size() });
+            float share = (wanted > 0)? static_cast<float>(allowed) / wanted : 1.0F;
+            float enlarge = std::min(2.0F, 1.0F / std::sqrt(std::max(share, 0.25F)));
+            
+            for (const auto &b : pending){
+                const ParticleStyle &style = PARTICLE_STYLES[b.style];
+                std::size_t count = std::min<std::size_t>(static_cast<std::size_t>(style.count * share), 
+                                                          particles.capacity() - particles.size());
+                particlesCut += style.count - count;
+                ++burstSerial;
+                
+                for (std::size_t k = 0; k < count; ++k){
+                    std::uint32_t noise = hashNoise(burstSerial, k);
+                    float direction = (noise & 0xFFFF) * (360.0F / 65536.0F), spread = (noise >> 16) / 65536.0F;
+                    float speed = style.minSpeed + (style.maxSpeed - style.minSpeed) * spread;
+                    float lifetime = style.minLifetime + (style.maxLifetime - style.minLifetime) * (1.0F - spread);
+                    particles.push_back(Particle{ b.x, b.y, tableCos(direction) * speed, tableSin(direction) * speed, 
+                                                  0.0F, lifetime * simulationRate, style.size * enlarge, b.style });
+                }
+            }
+            pending.clear();
+        }
+        
+        // moves the particles [begin, end) by one tick, the batches are independent
+        void update(std::size_t begin, std::size_t end){
+            float drag[PARTICLE_STYLE_COUNT];
+            for (int i = 0; i < PARTICLE_STYLE_COUNT; ++i){ drag[i] = std::pow(PARTICLE_STYLES[i].drag, tickScale); }
+            
+            for (std::size_t i = begin; i < end; ++i){
+                Particle &p = particles[i];
+                p.x += p.dx * tickScale;   p.y += p.dy * tickScale;
+                p.dx *= drag[p.style];     p.dy *= drag[p.style];
+                p.age += 1.0F;
+            }
+        }
+        // the live particles as one block, the pending bursts are always empty between two ticks
+        void save(SaveWriter &out) const {
+            out.field(static_cast<std::uint64_t>(particlesCut));   out.field(burstSerial);
+            out.records(particles);
+        }
+        bool load(SaveReader &in){
+            std::uint64_t cut = 0;
+            in.field(cut);   in.field(burstSerial);
+            particlesCut = static_cast<unsigned long>(cut);
+            // read into the reserved buffer, a save of a larger buffer loses its newest particles
+            std::size_t count = in.count(savedBytes<Particle>()), kept = std::min(count, particles.capacity());
+            particles.resize(kept);
+            for (auto &p : particles){ Particle::fields(in, p); }
+            for (std::size_t i = kept; i < count  and  in.isValid(); ++i){ Particle skipped;  Particle::fields(in, skipped); }
+            for (const auto &p : particles){ if (p.style >= PARTICLE_STYLE_COUNT){ in.fail(); } }
+            pending.clear();
+            if (not in.isValid()){ particles.clear();  return false; }
+            return true;
+        }
+        
+        // removes the particles at the end of their lifetime
+        void removeDead(){
+            particles.erase(std::remove_if(particles.begin(), particles.end(), [](const Particle &p){ return p.age >= p.lifetime; }), 
+                            particles.end());
+        }
+        
+        // appends a quad per particle, (alpha) blends the position and the fade from the last tick to this one,
+        // with a camera (view) only the particles on the screen are added
+        void addQuads(sf::VertexArray &quads, float alpha, const sf::FloatRect *view = nullptr) const {
+            for (const auto &p : particles){
+                const ParticleStyle &style = PARTICLE_STYLES[p.style];
+                float fade = std::min(1.0F, (p.age - 1.0F + alpha) / p.lifetime), keep = 1.0F - fade;
+                float x = p.x + p.dx * tickScale * (alpha - 1.0F), y = p.y + p.dy * tickScale * (alpha - 1.0F);
+                float half = p.size * (0.5F + 0.5F * keep);
+                if (view != nullptr  and  not placeInView(*view, half, x, y)){ continue; }
+                
+                sf::Color color(static_cast<sf::Uint8>(style.startColor.r * keep + style.endColor.r * fade),
+                                static_cast<sf::Uint8>(style.startColor.g * keep + style.endColor.g * fade),
+                                static_cast<sf::Uint8>(style.startColor.b * keep + style.endColor.b * fade),
+                                static_cast<sf::Uint8>(255 * keep));
+                quads.append(sf::Vertex(sf::Vector2f(x - half, y - half), color));
+                quads.append(sf::Vertex(sf::Vector2f(x + half, y - half), color));
+                quads.append(sf::Vertex(sf::Vector2f(x + half, y + half), color));
+                quads.append(sf::Vertex(sf::Vector2f(x - half, y + half), color));
+            }
+        }
+    };
+    
+    
+    ////////////////////////////////// @c COLLISION-DETECTION-FUNCTION //////////////////////////////////
+    
+    
+    inline bool isCollided(float x1, float y1, float R1, float x2, float y2, float R2){
+        
+        // collision check between two entities using maths ---circle distance formula---
+        auto distanceSquareX = (x1 - x2) * (x1 - x2);
+        auto distanceSquareY = (y1 - y2) * (y1 - y2);
+        auto distanceSquareR = (R1 + R2) * (R1 + R2); // R -> radious
+        
+        return (distanceSquareX + distanceSquareY  <  distanceSquareR);
+    }
+    
+    // continuous version of (isCollided) for two entities which moved by (step1) and (step2) during the tick
+    // and are now at (x1, y1) and (x2, y2) : in the frame of the second one the first one moved along a segment,
+    // so they touched within the tick if the segment comes closer than (R1 + R2) to the origin
+    inline bool isSweptCollided(float x1, float y1, float stepX1, float stepY1, float R1, 
+                                float x2, float y2, float stepX2, float stepY2, float R2){
+        
+        float moveX = stepX1 - stepX2, moveY = stepY1 - stepY2;         // the relative motion
+        float startX = (x1 - x2) - moveX, startY = (y1 - y2) - moveY;   // the relative position at the tick start
+        float moveSquare = moveX * moveX + moveY * moveY;
+        
+        // the point of the segment closest to the origin, (t) = 0 at the tick start and 1 at its end
+        float t = (moveSquare > 0.0F)? -(startX * moveX + startY * moveY) / moveSquare : 0.0F;
+        t = std::min(1.0F, std::max(0.0F, t));
+        float closestX = startX + moveX * t, closestY = startY + moveY * t;
+        
+        return (closestX * closestX + closestY * closestY  <  (R1 + R2) * (R1 + R2));
+    }
+    
+    // the collision fields of many circles packed one after the other, (dx, dy) is the velocity
+    struct PackedCircles { const float *x, *y, *dx, *dy, *R; };
+    
+    constexpr std::size_t NARROWPHASE_BATCH = 32; // circles tested into one hit mask
+    
+    // (isSweptCollided) of one circle against the packed circles [first, first + count), LANES circles per 
+    // instruction, the step of a packed circle is its velocity * (stepScale); bit k of the returned mask is set
+    // when the circle (first + k) is hit, (count) is at most (NARROWPHASE_BATCH)
+    // every lane does the same float operations in the same order as (isSweptCollided), so both give the same hits
+    inline std::uint32_t sweptHitMask(float x1, float y1, float stepX1, float stepY1, float R1, 
+                                      const PackedCircles &circles, std::size_t first, std::size_t count, float stepScale){
+        std::uint32_t hits = 0;
+        std::size_t k = 0;
+#ifdef ASTEROID_SIMD
+        const FloatLanes posX = splat(x1), posY = splat(y1), stepX = splat(stepX1), stepY = splat(stepY1), radious = splat(R1);
+        const FloatLanes scale = splat(stepScale), zero = splat(0.0F), one = splat(1.0F);
+        for (; k + LANES <= count; k += LANES){
+            const std::size_t c = first + k;
+            FloatLanes moveX = sub(stepX, mul(loadLanes(circles.dx + c), scale));
+            FloatLanes moveY = sub(stepY, mul(loadLanes(circles.dy + c), scale));
+            FloatLanes startX = sub(sub(posX, loadLanes(circles.x + c)), moveX);
+            FloatLanes startY = sub(sub(posY, loadLanes(circles.y + c)), moveY);
+            FloatLanes moveSquare = add(mul(moveX, moveX), mul(moveY, moveY));
+            
+            // (t) of the closest point, 0 for the circles not moving relative to each other, clamped to 0 - 1
+            FloatLanes moving = lessThan(zero, moveSquare);
+            FloatLanes t = divide(sub(zero, add(mul(startX, moveX), mul(startY, moveY))), select(moving, moveSquare, one));
+            t = select(moving, t, zero);
+            t = select(lessThan(zero, t), t, zero);   t = select(lessThan(t, one), t, one);
+            
+            FloatLanes closestX = add(startX, mul(moveX, t)), closestY = add(startY, mul(moveY, t));
+            FloatLanes reach = add(radious, loadLanes(circles.R + c));
+            FloatLanes hit = lessThan(add(mul(closestX, closestX), mul(closestY, closestY)), mul(reach, reach));
+            hits |= static_cast<std::uint32_t>(maskBits(hit)) << k;
+        }
+#endif
+        for (; k < count; ++k){ // the remaining circles one by one
+            const std::size_t c = first + k;
+            if ( isSweptCollided(x1, y1, stepX1, stepY1, R1, circles.x[c], circles.y[c], 
+                                 circles.dx[c] * stepScale, circles.dy[c] * stepScale, circles.R[c]) ){ hits |= 1U << k; }
+        }
+        return hits;
+    }
+    
+    
+    ////////////////////////////////// @c COLLISION-HULLS //////////////////////////////////
+    
+    
+    const int HULL_MAX_VERTICES = 12;
+    
+    // the convex outline of one frame around the frame center (not rotated), with the unit normal of each edge
+    // (the edge from vertex i to vertex i + 1) and the projection of the whole hull on it [low, high]
+    struct HullShape { 
+        int count;  
+        float x[HULL_MAX_VERTICES], y[HULL_MAX_VERTICES];
+        float normalX[HULL_MAX_VERTICES], normalY[HULL_MAX_VERTICES], low[HULL_MAX_VERTICES], high[HULL_MAX_VERTICES]; 
+    };
+    
+    class RockHulls { // the hit shapes of the asteroid frames, baked offline from the sprite alpha (Tools/HullBaker.cpp)
+        
+        private : 
+        
+        std::vector<HullShape> shapes[ANIMATION_COUNT];
+        float boundRadius[ANIMATION_COUNT];
+        /*
+        shapes      : the hull of every frame of a clip, a clip with no hulls keeps the circle of its entities
+        boundRadius : the largest vertex distance of the hulls of a clip, the circle around all of them
+        
+        a pair is tested in two levels : the circles around the hulls first (the broadphase packs them), then only
+        the pairs whose circles touch are tested against the hull by separating axes, at most HULL_MAX_VERTICES + 3
+        axes a pair
+        
+        file format : "asteroid-hulls 1", then for every sheet a line "sheet <file> <frameW> <frameH> <frameCount>"
+                      and one line per frame "<vertex count> <x> <y> ..." in pixels around the frame center
+        */
+        
+        // false when the projections of the hull and of the circle of radius (R) moving from (x1, y1) to (x2, y2)
+        // on (axisX, axisY) have a gap between them, the axis separates them
+        static bool overlapOn(const HullShape &hull, float axisX, float axisY, float x1, float y1, float x2, float y2, float R){
+            float length = std::sqrt(axisX * axisX  +  axisY * axisY);
+            if (length == 0.0F){ return true; }
+            float hullMin = hull.x[0] * axisX + hull.y[0] * axisY, hullMax = hullMin;
+            for (int v = 1; v < hull.count; ++v){ 
+                float p = hull.x[v] * axisX + hull.y[v] * axisY;
+                hullMin = std::min(hullMin, p);   hullMax = std::max(hullMax, p); 
+            }
+            float p1 = x1 * axisX + y1 * axisY, p2 = x2 * axisX + y2 * axisY, reach = R * length;
+            return not (hullMax < std::min(p1, p2) - reach  or  std::max(p1, p2) + reach < hullMin);
+        }
+        static int closestVertex(const HullShape &hull, float x, float y){
+            int closest = 0;  float best = (hull.x[0] - x) * (hull.x[0] - x) + (hull.y[0] - y) * (hull.y[0] - y);
+            for (int v = 1; v < hull.count; ++v){
+                float d = (hull.x[v] - x) * (hull.x[v] - x) + (hull.y[v] - y) * (hull.y[v] - y);
+                if (d < best){ best = d;  closest = v; }
+            }
+            return closest;
+        }
+        
+        public : 
+        
+        RockHulls() noexcept { std::fill_n(boundRadius, ANIMATION_COUNT, 0.0F); }
+        ~RockHulls() noexcept {}
+        
+        // reads the hulls of the sheets which have the frame layout of a clip, a broken file loads nothing
+        bool load(const std::string &file){
+            std::ifstream in(file);
+            std::string word;  int version = 0;
+            if (not (in >> word >> version)  or  word != "asteroid-hulls"  or  version != 1){ return false; }
+            
+            std::string sheetFile;  int frameW, frameH, frameCount;
+            while (in >> word >> sheetFile >> frameW >> frameH >> frameCount){
+                if (word != "sheet"  or  frameCount <= 0){ return clear(); }
+                std::vector<HullShape> frames(frameCount);
+                for (auto &hull : frames){
+                    if (not (in >> hull.count)  or  hull.count < 3  or  hull.count > HULL_MAX_VERTICES){ return clear(); }
+                    for (int v = 0; v < hull.count; ++v){ if (not (in >> hull.x[v] >> hull.y[v])){ return clear(); } }
+                    
+                    // the edges have to turn the same way all around, otherwise the hull is not convex
+                    float turn = 0.0F;
+                    for (int v = 0; v < hull.count; ++v){
+                        int next = (v + 1) % hull.count, after = (v + 2) % hull.count;
+                        float edgeX = hull.x[next] - hull.x[v], edgeY = hull.y[next] - hull.y[v];
+                        float cross = edgeX * (hull.y[after] - hull.y[next])  -  edgeY * (hull.x[after] - hull.x[next]);
+                        if (cross * turn < 0.0F){ return clear(); }
+                        turn = (cross != 0.0F)? cross : turn;
+                        float length = std::sqrt(edgeX * edgeX  +  edgeY * edgeY);
+                        if (length == 0.0F){ return clear(); }
+                        hull.normalX[v] = edgeY / length;   hull.normalY[v] = -edgeX / length;
+                    }
+                    for (int v = 0; v < hull.count; ++v){
+                        hull.low[v] = hull.high[v] = hull.x[0] * hull.normalX[v] + hull.y[0] * hull.normalY[v];
+                        for (int w = 1; w < hull.count; ++w){
+                            float p = hull.x[w] * hull.normalX[v] + hull.y[w] * hull.normalY[v];
+                            hull.low[v] = std::min(hull.low[v], p);   hull.high[v] = std::max(hull.high[v], p);
+                        }
+                    }
+                }
+                for (short int i = 0; i < ANIMATION_COUNT; ++i){
+                    const SpriteSheet &sheet = SPRITE_SHEETS[i];
+                    if (sheetFile != sheet.file  or  frameW != sheet.frameW  or  frameH != sheet.frameH  or  frameCount != sheet.frameCount){ continue; }
+                    shapes[i] = frames;
+                    for (const auto &hull : frames){
+                        for (int v = 0; v < hull.count; ++v){ boundRadius[i] = std::max(boundRadius[i], std::hypot(hull.x[v], hull.y[v])); }
+                    }
+                }
+            }
+            return getFrameCount() > 0;
+        }
+        bool clear(){
+            for (auto &frames : shapes){ frames.clear(); }
+            std::fill_n(boundRadius, ANIMATION_COUNT, 0.0F);
+            return false;
+        }
+        
+        inline bool has(std::uint8_t clip) const { return not shapes[clip].empty(); }
+        // the circle of the first test level : around the hulls, or the circle (R) of an entity with no hulls
+        inline float radiusOf(std::uint8_t clip, float R) const { return has(clip)? boundRadius[clip] : R; }
+        float getMaxRadius() const { return *std::max_element(boundRadius, boundRadius + ANIMATION_COUNT); }
+        std::size_t getFrameCount() const {
+            std::size_t frames = 0;
+            for (const auto &clipShapes : shapes){ frames += clipShapes.size(); }
+            return frames;
+        }
+        
+        // the second test level : does a circle of radius (R) moving from (x1, y1) to (x2, y2) touch the hull of 
+        // the frame (playhead) of a (clip) drawn at (hullX, hullY) and rotated by (degree)? true for a clip with no hulls
+        bool hits(std::uint8_t clip, float playhead, float hullX, float hullY, float degree, float x1, float y1, float x2, float y2, float R) const {
+            if (not has(clip)){ return true; }
+            const HullShape &hull = shapes[clip][std::min<std::size_t>(static_cast<std::size_t>(playhead), shapes[clip].size() - 1)];
+            
+            // the path into the frame of the hull (the sprites are drawn 90 degrees further than their angle)
+            float cosine = tableCos(degree + 90.0F), sine = tableSin(degree + 90.0F);
+            float localX1 =  (x1 - hullX) * cosine + (y1 - hullY) * sine,  localY1 = -(x1 - hullX) * sine + (y1 - hullY) * cosine;
+            float localX2 =  (x2 - hullX) * cosine + (y2 - hullY) * sine,  localY2 = -(x2 - hullX) * sine + (y2 - hullY) * cosine;
+            
+            // separating axes : the edge normals of the hull, the normal of the path, and from the ends of the path to the
+            // nearest vertices (where the round ends of the moving circle meet the corners of the hull)
+            for (int v = 0; v < hull.count; ++v){ // the hull side of these axes is baked into [low, high]
+                float p1 = localX1 * hull.normalX[v] + localY1 * hull.normalY[v], p2 = localX2 * hull.normalX[v] + localY2 * hull.normalY[v];
+                if (hull.high[v] < std::min(p1, p2) - R  or  std::max(p1, p2) + R < hull.low[v]){ return false; }
+            }
+            if (not overlapOn(hull, localY1 - localY2, localX2 - localX1, localX1, localY1, localX2, localY2, R)){ return false; }
+            int near1 = closestVertex(hull, localX1, localY1), near2 = closestVertex(hull, localX2, localY2);
+            if (not overlapOn(hull, hull.x[near1] - localX1, hull.y[near1] - localY1, localX1, localY1, localX2, localY2, R)){ return false; }
+            return overlapOn(hull, hull.x[near2] - localX2, hull.y[near2] - localY2, localX1, localY1, localX2, localY2, R);
+        }
+    };
+    
+    
+    ////////////////////////////////// @c SPATIAL-HASH-BROADPHASE //////////////////////////////////
+    
+    
+    const int MAX_GRID_CELLS = 128; // cells of the broadphase grid each way
+    
+    class SpatialHash { // a uniform grid over the playfield, rebuilt from scratch on every frame
+        
+        private : 
+        
+        float cellSize;  int cols, rows;
+        std::vector<int> cellStart; // index of the first entry of each cell inside (entries)
+        std::vector<int> cellFill;  // write cursor of each cell while sorting
+        std::vector<int> entries;   // the inserted object indices, sorted cell by cell
+        std::vector<float> packedX, packedY, packedDx, packedDy, packedR; // the collision fields of (entries)
+        /*
+        cellSize   : size of a square cell, it is at least the largest collision distance (R1 + R2)
+                     so every colliding pair is found within the 3x3 cells around an object
+        cols, rows : the grid dimensions, the grid wraps around at its edges just like the screen
+        packed...  : a copy of the fields in the order of (entries), so the entities of a cell are 
+                     next to each other in memory and the narrowphase tests them LANES at a time
+        */
+        inline int wrapCol(int cx) const { cx %= cols;  return (cx < 0)? cx + cols : cx; }
+        inline int wrapRow(int cy) const { cy %= rows;  return (cy < 0)? cy + rows : cy; }
+        
+        inline void fitGrid(float worldW, float worldH){
+            // at least 3 cells each way, otherwise the wrapped 3x3 neighbourhood visits a cell twice; a large world 
+            // is folded onto at most MAX_GRID_CELLS each way, so far apart cells share a cell (which only adds 
+            // candidates, the awake chunks all fit into the folded grid) and the rebuild does not grow with the world
+            cols = std::min(MAX_GRID_CELLS, std::max(3, static_cast<int>(std::ceil(worldW / cellSize))));
+            rows = std::min(MAX_GRID_CELLS, std::max(3, static_cast<int>(std::ceil(worldH / cellSize))));
+        }
+        
+        public : 
+        
+        SpatialHash(float maxCollisionDistance) noexcept { 
+            cellSize = maxCollisionDistance;  cols = rows = 3; 
+        }
+        // allocates the grid for the playfield and room for (maxEntities) up front
+        void reserve(std::size_t maxEntities, float worldW, float worldH){
+            fitGrid(worldW, worldH);
+            cellStart.reserve(cols * rows + 1);  cellFill.reserve(cols * rows);
+            entries.reserve(maxEntities);
+            for (auto *field : { &packedX, &packedY, &packedDx, &packedDy, &packedR }){ field->reserve(maxEntities); }
+        }
+        ~SpatialHash() noexcept {}
+        
+        inline int colOf(float x) const { return wrapCol(static_cast<int>(std::floor(x / cellSize))); }
+        inline int rowOf(float y) const { return wrapRow(static_cast<int>(std::floor(y / cellSize))); }
+        
+        // clear the grid and insert the given entities (a counting sort, the vectors are reused every frame),
+        // the entities with (hulls) are packed with the circle around their hulls
+        void rebuild(const EntityPool &pool, float worldW, float worldH, const RockHulls *hulls = nullptr){
+            fitGrid(worldW, worldH);
+            cellStart.assign(cols * rows + 1, 0);
+            entries.resize(pool.size());
+            for (auto *field : { &packedX, &packedY, &packedDx, &packedDy, &packedR }){ field->resize(pool.size()); }
+            
+            for (std::size_t i = 0; i < pool.size(); ++i){ ++cellStart[rowOf(pool.y[i]) * cols + colOf(pool.x[i]) + 1]; }
+            for (int c = 0; c < cols * rows; ++c){ cellStart[c + 1] += cellStart[c]; }
+            
+            cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+            for (std::size_t i = 0; i < pool.size(); ++i){
+                int e = cellFill[rowOf(pool.y[i]) * cols + colOf(pool.x[i])]++;
+                entries[e] = static_cast<int>(i);
+                packedX[e]  = pool.x[i];    packedY[e]  = pool.y[i];
+                packedDx[e] = pool.dx[i];   packedDy[e] = pool.dy[i];   
+                packedR[e]  = (hulls != nullptr)? hulls->radiusOf(pool.clip[i], pool.R[i]) : pool.R[i];
+            }
+        }
+        // calls (visit) with the pool index of every inserted entity in the 3x3 cells around (x, y)
+        template <typename Visitor>
+        void query(float x, float y, Visitor &&visit) const {
+            int cx = colOf(x), cy = rowOf(y);
+            for (int oy = -1; oy <= 1; ++oy){
+                for (int ox = -1; ox <= 1; ++ox){
+                    int c = wrapRow(cy + oy) * cols + wrapCol(cx + ox);
+                    for (int e = cellStart[c]; e < cellStart[c + 1]; ++e){ visit(entries[e]); }
+                }
+            }
+        }
+        // calls (visit) with the range [first, end) of the entries of every cell within (reach) of the segment 
+        // (x1, y1) - (x2, y2), so a fast object is tested against everything it passed during the tick and not 
+        // only where it ended; a cell is visited once
+        template <typename Visitor>
+        void querySegment(float x1, float y1, float x2, float y2, float reach, Visitor &&visit) const {
+            int firstCol = static_cast<int>(std::floor((std::min(x1, x2) - reach) / cellSize));
+            int firstRow = static_cast<int>(std::floor((std::min(y1, y2) - reach) / cellSize));
+            // a range longer than the grid is cut to the grid, so no wrapped cell is visited twice
+            int colCount = std::min(cols, static_cast<int>(std::floor((std::max(x1, x2) + reach) / cellSize)) - firstCol + 1);
+            int rowCount = std::min(rows, static_cast<int>(std::floor((std::max(y1, y2) + reach) / cellSize)) - firstRow + 1);
+            
+            for (int oy = 0; oy < rowCount; ++oy){
+                for (int ox = 0; ox < colCount; ++ox){
+                    int c = wrapRow(firstRow + oy) * cols + wrapCol(firstCol + ox);
+                    if (cellStart[c] < cellStart[c + 1]){ visit(cellStart[c], cellStart[c + 1]); }
+                }
+            }
+        }
+        inline float getCellSize() const { return cellSize; }
+        inline int entryAt(int e) const { return entries[e]; }
+        inline PackedCircles getPacked() const { 
+            return PackedCircles{ packedX.data(), packedY.data(), packedDx.data(), packedDy.data(), packedR.data() }; 
+        }
+    };
+    
+    
+    ////////////////////////////////// @c WORLD-CHUNKS //////////////////////////////////
+    
+    
+    // an asteroid of a sleeping chunk, kept out of the pool, (since) is the tick it fell asleep
+    struct SleepingRock { 
+        float x, y, dx, dy, angle, R, playhead;  std::uint8_t clip;  std::uint64_t since; 
+        template <typename Stream, typename Self> static void fields(Stream &io, Self &rock){
+            io.field(rock.x);       io.field(rock.y);   io.field(rock.dx);         io.field(rock.dy);
+            io.field(rock.angle);   io.field(rock.R);   io.field(rock.playhead);   io.field(rock.clip);   io.field(rock.since);
+        }
+    };
+    
+    class ChunkGrid { // splits a large world into chunks of one screen, only the chunks around the camera are simulated
+        
+        private : 
+        
+        int cols, rows, cameraChunk;
+        float chunkW, chunkH;
+        std::vector<std::uint8_t> awake;
+        std::vector<std::vector<SleepingRock>> sleepers;
+        std::size_t sleeperCount;
+        unsigned long wokenRocks, sleptRocks;
+        /*
+        awake       : the 3 x 3 chunks around the camera chunk (every chunk of a world up to 3 x 3 chunks), only their 
+                      asteroids are in the pool, so only they are moved, tested for collisions and drawn
+        sleepers    : the asteroids of each sleeping chunk, they do not move while asleep, when their chunk wakes up
+                      they go back into the pool at the place they would have moved to in the ticks they slept
+        wokenRocks,
+        sleptRocks  : the asteroids moved into and out of the pool in the last tick (for the stats)
+        */
+        inline int wrap(int c, int count) const { c %= count;  return (c < 0)? c + count : c; }
+        
+        // puts the sleepers of chunk (c) back into the pool, a full pool leaves the rest asleep
+        void wake(int c, EntityStore &store, std::uint64_t tickNo){
+            EntityPool &rocks = store[ASTEROID];
+            std::vector<SleepingRock> &list = sleepers[c];
+            std::size_t kept = 0;
+            for (const auto &rock : list){
+                if (rocks.size() == rocks.capacity()){ list[kept++] = rock;  continue; }
+                float steps = (tickNo - rock.since) * tickScale;
+                float x = std::fmod(rock.x + rock.dx * steps, worldW), y = std::fmod(rock.y + rock.dy * steps, worldH);
+                x += (x < 0.0F)? worldW : 0.0F;   y += (y < 0.0F)? worldH : 0.0F;
+                EntityHandle handle = store.spawn(ASTEROID, static_cast<AnimationId>(rock.clip), x, y, rock.angle, rock.R, rock.dx, rock.dy);
+                rocks.playhead[store.indexOf(handle)] = rock.playhead;
+                ++wokenRocks;
+            }
+            sleeperCount -= list.size() - kept;
+            list.resize(kept);
+        }
+        
+        public : 
+        
+        ChunkGrid() noexcept { cols = rows = 1;  cameraChunk = -1;  chunkW = chunkH = 1.0F;  sleeperCount = 0;  wokenRocks = sleptRocks = 0; }
+        ~ChunkGrid() noexcept {}
+        
+        // chunks of (width x height) over the world, all awake and empty
+        void reset(float width, float height){
+            chunkW = width;   chunkH = height;
+            cols = std::max(1, static_cast<int>(std::lround(worldW / width)));
+            rows = std::max(1, static_cast<int>(std::lround(worldH / height)));
+            awake.assign(cols * rows, 1);   sleepers.assign(cols * rows, std::vector<SleepingRock>());
+            sleeperCount = 0;   cameraChunk = -1;   wokenRocks = sleptRocks = 0;
+        }
+        
+        inline bool isLarge() const { return cols * rows > 1; }
+        inline int chunkOf(float x, float y) const { 
+            return wrap(static_cast<int>(std::floor(y / chunkH)), rows) * cols + wrap(static_cast<int>(std::floor(x / chunkW)), cols); 
+        }
+        inline int getChunkCount() const { return cols * rows; }
+        inline int getAwakeCount() const { return static_cast<int>(std::count(awake.begin(), awake.end(), 1)); }
+        inline std::size_t getSleeperCount() const { return sleeperCount; }
+        inline unsigned long getWokenCount() const { return wokenRocks; }
+        inline unsigned long getSleptCount() const { return sleptRocks; }
+        
+        // wakes the chunks around the camera at (x, y) and puts the others to sleep : the awake asteroids now in a
+        // sleeping chunk are copied out of the pool and marked dead, the caller removes them with the dead ones
+        void follow(float x, float y, EntityStore &store, std::uint64_t tickNo){
+            wokenRocks = sleptRocks = 0;
+            if (not isLarge()){ return; }
+            
+            int camera = chunkOf(x, y);
+            if (camera != cameraChunk){
+                cameraChunk = camera;
+                int cx = camera % cols, cy = camera / cols;
+                std::fill(awake.begin(), awake.end(), 0);
+                for (int oy = -1; oy <= 1; ++oy){
+                    for (int ox = -1; ox <= 1; ++ox){ awake[wrap(cy + oy, rows) * cols + wrap(cx + ox, cols)] = 1; }
+                }
+                for (int c = 0; c < cols * rows; ++c){ if (awake[c]  and  not sleepers[c].empty()){ wake(c, store, tickNo); } }
+            }
+            EntityPool &rocks = store[ASTEROID];
+            for (std::size_t i = 0; i < rocks.size(); ++i){
+                if (not rocks.life[i]){ continue; }
+                int c = chunkOf(rocks.x[i], rocks.y[i]);
+                if (awake[c]){ continue; }
+                sleepers[c].push_back(SleepingRock{ rocks.x[i], rocks.y[i], rocks.dx[i], rocks.dy[i], rocks.angle[i], rocks.R[i], 
+                                                    rocks.playhead[i], rocks.clip[i], tickNo });
+                rocks.life[i] = false;
+                ++sleeperCount;   ++sleptRocks;
+            }
+        }
+        
+        // marks the entities [begin, end) of a pool dead when they are in a sleeping chunk (the bullets)
+        void killAsleep(EntityPool &pool, std::size_t begin, std::size_t end) const {
+            if (not isLarge()){ return; }
+            for (std::size_t i = begin; i < end; ++i){ pool.life[i] &= awake[chunkOf(pool.x[i], pool.y[i])]; }
+        }
+        
+        template <typename Visitor>
+        void forEachSleeper(Visitor &&visit) const { for (const auto &list : sleepers){ for (const auto &rock : list){ visit(rock); } } }
+        
+        void save(SaveWriter &out) const {
+            out.field(cols);   out.field(rows);
+            for (const auto &list : sleepers){ out.records(list); }
+        }
+        // the camera chunk is found again by the next tick, which wakes the chunks around it
+        bool load(SaveReader &in){
+            int savedCols = 0, savedRows = 0;
+            in.field(savedCols);   in.field(savedRows);
+            if (savedCols != cols  or  savedRows != rows){ in.fail(); }
+            sleeperCount = 0;
+            for (auto &list : sleepers){
+                if (in.isValid()){ in.records(list); }
+                for (const auto &rock : list){ if (rock.clip >= ANIMATION_COUNT){ in.fail(); } }
+                sleeperCount += list.size();
+            }
+            std::fill(awake.begin(), awake.end(), 1);
+            cameraChunk = -1;
+            return in.isValid();
+        }
+    };
+    
+    
+    ////////////////////////////////// @c FLOW-FIELD //////////////////////////////////
+    
+    
+    const float FLOW_CELL = 40.0F;     // the smallest cell of the flow field, a big asteroid covers about one cell
+    const float FLOW_REFRESH = 0.1F;   // seconds between two flow fields, a field is built during the ticks of the one before
+    
+    // the steps to the 8 neighbour cells (the odd ones are diagonal), (FLOW_NONE) is a cell with no way to the target
+    const int FLOW_STEP_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 }, FLOW_STEP_Y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    const std::uint8_t FLOW_NONE = 8;
+    
+    // a big asteroid the flow goes around
+    struct FlowObstacle { float x, y, R; };
+    
+    class FlowField { // the way to the ship from every cell of a coarse grid around the big asteroids, shared by all the hunters
+        
+        private : 
+        
+        int cols, rows;  float cellW, cellH;
+        std::vector<std::uint8_t> directions;
+        std::vector<FlowObstacle> obstacles;
+        float targetX, targetY;
+        bool pending;
+        std::vector<std::uint8_t> blocked, lastBlocked, built;
+        std::vector<std::uint16_t> distance;
+        std::vector<int> frontier;
+        int lastTarget;
+        bool quit, hasRequest, busy;
+        std::mutex lock;
+        std::condition_variable wake, finished;
+        std::atomic<unsigned long> builds, reusedBuilds, lateBuilds;
+        std::atomic<std::uint32_t> lastBuildMicroseconds;
+        std::thread thread;
+        /*
+        cols, rows   : the grid over the whole world, it wraps around like the world, (cellW x cellH) is at least
+                       FLOW_CELL and a large world gets larger cells (at most MAX_GRID_CELLS each way)
+        directions   : the field the ticks read, the FLOW_STEP towards the target of each cell
+        obstacles,
+        targetX, Y   : the input of the build on the worker thread, (pending) while that build is not taken yet
+        blocked      : the cells under a big asteroid, (lastBlocked) and (lastTarget) are the input of the last build,
+                       an unchanged input keeps its field (built) instead of searching again
+        distance     : the steps from each cell to the target, found by a breadth first search through (frontier)
+        lateBuilds   : the builds not done when the game took them, the game waited for those
+        */
+        inline int wrap(int c, int count) const { c %= count;  return (c < 0)? c + count : c; }
+        inline int cellAt(int cx, int cy) const { return wrap(cy, rows) * cols + wrap(cx, cols); }
+        
+        // a diagonal step must not cut the corner between two blocked cells
+        inline bool canStep(int cx, int cy, int k) const {
+            return not (k & 1)  or  (not blocked[cellAt(cx + FLOW_STEP_X[k], cy)]  and  not blocked[cellAt(cx, cy + FLOW_STEP_Y[k])]);
+        }
+        
+        void build(){
+            std::fill(blocked.begin(), blocked.end(), 0);
+            for (const auto &rock : obstacles){
+                int firstCol = static_cast<int>(std::floor((rock.x - rock.R) / cellW)), lastCol = static_cast<int>(std::floor((rock.x + rock.R) / cellW));
+                int firstRow = static_cast<int>(std::floor((rock.y - rock.R) / cellH)), lastRow = static_cast<int>(std::floor((rock.y + rock.R) / cellH));
+                for (int cy = firstRow; cy <= lastRow; ++cy){
+                    for (int cx = firstCol; cx <= lastCol; ++cx){ blocked[cellAt(cx, cy)] = 1; }
+                }
+            }
+            int target = cellOf(targetX, targetY);
+            blocked[target] = 0; // the ship is always reachable, also when it flies over an asteroid
+            if (target == lastTarget  and  blocked == lastBlocked){ ++reusedBuilds;  return; }
+            lastTarget = target;   lastBlocked = blocked;
+            
+            std::fill(distance.begin(), distance.end(), UINT16_MAX);
+            frontier.clear();
+            frontier.push_back(target);   distance[target] = 0;
+            for (std::size_t f = 0; f < frontier.size(); ++f){
+                int c = frontier[f], cx = c % cols, cy = c / cols;
+                for (int k = 0; k < 8; ++k){
+                    int n = cellAt(cx + FLOW_STEP_X[k], cy + FLOW_STEP_Y[k]);
+                    if (blocked[n]  or  distance[n] != UINT16_MAX  or  not canStep(cx, cy, k)){ continue; }
+                    distance[n] = distance[c] + 1;
+                    frontier.push_back(n);
+                }
+            }
+            // every cell points to its neighbour nearest to the target, a blocked cell too, so a hunter pushed into it gets out
+            for (int c = 0; c < cols * rows; ++c){
+                int cx = c % cols, cy = c / cols;
+                std::uint16_t best = distance[c];
+                built[c] = FLOW_NONE;
+                for (int k = 0; k < 8; ++k){
+                    int n = cellAt(cx + FLOW_STEP_X[k], cy + FLOW_STEP_Y[k]);
+                    if (distance[n] < best  and  (blocked[c]  or  canStep(cx, cy, k))){ best = distance[n];  built[c] = static_cast<std::uint8_t>(k); }
+                }
+            }
+        }
+        
+        void run(){
+            while (true){
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    wake.wait(guard, [&]{ return quit  or  hasRequest; });
+                    if (quit){ return; }
+                    hasRequest = false;
+                }
+                auto start = std::chrono::steady_clock::now();
+                build();
+                ++builds;
+                lastBuildMicroseconds = static_cast<std::uint32_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+                { std::lock_guard<std::mutex> guard(lock);  busy = false; }
+                finished.notify_one();
+            }
+        }
+        
+        // sends (obstacles) and the target to the worker thread
+        void submit(){
+            { std::lock_guard<std::mutex> guard(lock);  hasRequest = busy = true; }
+            wake.notify_one();
+            pending = true;
+        }
+        // takes the field of the pending build, waits for it when it is not done yet
+        void collect(){
+            if (not pending){ return; }
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if (busy){ ++lateBuilds;  finished.wait(guard, [&]{ return not busy; }); }
+            }
+            std::copy(built.begin(), built.end(), directions.begin());
+            pending = false;
+        }
+        
+        public : 
+        
+        FlowField() : builds(0), reusedBuilds(0), lateBuilds(0), lastBuildMicroseconds(0) {
+            cols = rows = 1;   cellW = cellH = FLOW_CELL;   targetX = targetY = 0.0F;   lastTarget = -1;
+            pending = quit = hasRequest = busy = false;
+            thread = std::thread(&FlowField::run, this);
+        }
+        ~FlowField(){
+            { std::lock_guard<std::mutex> guard(lock);  quit = true; }
+            wake.notify_one();
+            thread.join();
+        }
+        
+        // room for the big asteroids of a pool of (maxRocks)
+        void reserve(std::size_t maxRocks){ obstacles.reserve(maxRocks); }
+        
+        // a grid over the world with no way anywhere yet (the hunters fly straight at the ship)
+        void reset(){
+            collect();
+            cols = std::min(MAX_GRID_CELLS, std::max(3, static_cast<int>(worldW / FLOW_CELL)));
+            rows = std::min(MAX_GRID_CELLS, std::max(3, static_cast<int>(worldH / FLOW_CELL)));
+            cellW = worldW / cols;   cellH = worldH / rows;
+            for (auto *cells : { &directions, &built }){ cells->assign(cols * rows, FLOW_NONE); }
+            for (auto *cells : { &blocked, &lastBlocked }){ cells->assign(cols * rows, 0); }
+            distance.assign(cols * rows, UINT16_MAX);
+            frontier.clear();   frontier.reserve(cols * rows);
+            lastTarget = -1;
+        }
+        
+        // the ticks read the field built since the last refresh, and the worker starts on the field of the big asteroids 
+        // and the ship (x, y) of this tick; a field always changes at the same tick, so the game plays the same on any machine
+        void refresh(const EntityPool &rocks, float x, float y){
+            collect();
+            obstacles.clear();
+            for (std::size_t i = 0; i < rocks.size(); ++i){
+                if (rocks.life[i]  and  rocks.R[i] == 20){ obstacles.push_back(FlowObstacle{ rocks.x[i], rocks.y[i], rocks.R[i] }); }
+            }
+            targetX = x;   targetY = y;
+            submit();
+        }
+        
+        inline int cellOf(float x, float y) const { 
+            return cellAt(static_cast<int>(std::floor(x / cellW)), static_cast<int>(std::floor(y / cellH))); 
+        }
+        // the step (FLOW_STEP index) from the cell at (x, y) towards the target, or FLOW_NONE
+        inline std::uint8_t directionAt(float x, float y) const { return directions[cellOf(x, y)]; }
+        inline float getCellSize() const { return std::max(cellW, cellH); }
+        inline int getCols() const { return cols; }
+        inline int getRows() const { return rows; }
+        inline unsigned long getBuildCount() const { return builds; }
+        inline unsigned long getReusedCount() const { return reusedBuilds; }
+        inline unsigned long getLateCount() const { return lateBuilds; }
+        inline std::uint32_t getBuildMicroseconds() const { return lastBuildMicroseconds; }
+        
+        // the field in use and the input of the pending build, a loaded pending build is started again
+        void save(SaveWriter &out) const {
+            out.field(cols);   out.field(rows);
+            out.vector(directions);
+            out.field(pending);   out.vector(obstacles);   out.field(targetX);   out.field(targetY);
+        }
+        bool load(SaveReader &in){
+            collect();
+            int savedCols = 0, savedRows = 0;
+            bool savedPending = false;
+            in.field(savedCols);   in.field(savedRows);
+            if (savedCols != cols  or  savedRows != rows){ in.fail(); }
+            if (in.isValid()){ in.vector(directions); }
+            in.field(savedPending);   in.vector(obstacles);   in.field(targetX);   in.field(targetY);
+            if (in.isValid()  and  directions.size() != built.size()){ in.fail(); }
+            for (auto direction : directions){ if (direction > FLOW_NONE){ in.fail(); } }
+            if (not in.isValid()){ return false; }
+            if (savedPending){ submit(); }
+            return true;
+        }
+    };
+    
+    
+    const float HUNTER_SPEED = 2.5F;     // per reference tick, half of the top speed of the ship, so it can get away
+    const float HUNTER_STEERING = 0.05F; // the part of the way from its velocity to the wanted one a hunter turns per reference tick
+    const float HUNTER_RADIUS = 15.0F;
+    
+    // steers the hunters [begin, end) along the flow field towards the ship at (shipX, shipY), a hunter
+    // near the ship or on a cell with no way flies straight at it (the shortest way across the wrapping edges)
+    void updateHunters(EntityPool &hunters, const FlowField &flow, float shipX, float shipY, std::size_t begin, std::size_t end){
+        
+        const float steer = 1.0F - std::pow(1.0F - HUNTER_STEERING, tickScale), near = flow.getCellSize() * 2.0F;
+        for (std::size_t i = begin; i < end; ++i){
+            float &x = hunters.x[i], &y = hunters.y[i], &dx = hunters.dx[i], &dy = hunters.dy[i];
+            
+            float toX = shipX - x, toY = shipY - y;
+            if (toX > worldW / 2.0F){ toX -= worldW; }   else if (toX < -worldW / 2.0F){ toX += worldW; }
+            if (toY > worldH / 2.0F){ toY -= worldH; }   else if (toY < -worldH / 2.0F){ toY += worldH; }
+            float distance = std::sqrt(toX * toX  +  toY * toY), wantX = 0.0F, wantY = 0.0F;
+            
+            std::uint8_t step = flow.directionAt(x, y);
+            if (step != FLOW_NONE  and  distance > near){
+                float length = (step & 1)? std::sqrt(0.5F) : 1.0F; // a diagonal step is a unit vector too
+                wantX = FLOW_STEP_X[step] * length;   wantY = FLOW_STEP_Y[step] * length;
+            }
+            else if (distance > 0.0F){ wantX = toX / distance;   wantY = toY / distance; }
+            
+            dx += (wantX * HUNTER_SPEED - dx) * steer;   dy += (wantY * HUNTER_SPEED - dy) * steer;
+            x += dx * tickScale;   y += dy * tickScale;
+            x = (x < 0.0F)? x + worldW : (worldW < x)? x - worldW : x;
+            y = (y < 0.0F)? y + worldH : (worldH < y)? y - worldH : y;
+            // the nose follows the velocity, the shorter way round so the drawing does not spin between two ticks
+            if (dx != 0.0F  or  dy != 0.0F){ 
+                hunters.angle[i] += std::remainder(std::atan2(dy, dx) / DEG_TO_RAD - hunters.angle[i], 360.0F); 
+            }
+        }
+    }
+    
+    
+    ////////////////////////////////// @c JOB-SYSTEM //////////////////////////////////
+    
+    
+    class JobSystem { // runs the batches of a loop on a fixed set of worker threads, idle workers steal batches
+        
+        private : 
+        
+        struct Job { 
+            std::size_t begin, end; 
+            void (*run)(const void *, std::size_t, std::size_t, unsigned int);  const void *loop; 
+        };
+        struct WorkQueue { std::mutex lock;  std::vector<Job> jobs;  std::size_t head = 0; };
+        
+        std::vector<std::thread> threads;
+        std::vector<WorkQueue> queues;
+        std::mutex wakeLock;
+        std::condition_variable wake, done;
+        std::uint64_t generation;
+        bool quit;
+        std::atomic<std::size_t> jobsLeft;
+        /*
+        threads    : the worker threads, the thread calling (parallelFor) is the worker 0 and works too
+        queues     : one queue of batches for each worker, the owner takes from the back, the others steal
+                     from the front (head) of it, every queue is allocated once for (MAX_BATCHES_PER_WORKER)
+        generation : counts the loops, a sleeping worker wakes up when it changes
+        jobsLeft   : the batches of the current loop which are not finished yet
+        */
+        static constexpr std::size_t MAX_BATCHES_PER_WORKER = 8;
+        
+        bool popJob(unsigned int worker, Job &job){
+            WorkQueue &queue = queues[worker];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.head == queue.jobs.size()){ return false; }
+            job = queue.jobs.back();  queue.jobs.pop_back();
+            return true;
+        }
+        bool stealJob(unsigned int worker, Job &job){
+            for (std::size_t k = 1; k < queues.size(); ++k){
+                WorkQueue &queue = queues[(worker + k) % queues.size()];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                if (queue.head == queue.jobs.size()){ continue; }
+                job = queue.jobs[queue.head++];
+                return true;
+            }
+            return false;
+        }
+        // runs batches until every queue is empty
+        void work(unsigned int worker){
+            Job job;
+            while (popJob(worker, job)  or  stealJob(worker, job)){
+                job.run(job.loop, job.begin, job.end, worker);
+                if (jobsLeft.fetch_sub(1, std::memory_order_acq_rel) == 1){ 
+                    std::lock_guard<std::mutex> guard(wakeLock);
+                    done.notify_all(); 
+                }
+            }
+        }
+        void workerLoop(unsigned int worker){
+            std::uint64_t seenGeneration = 0;
+            while (true){
+                {
+                    std::unique_lock<std::mutex> guard(wakeLock);
+                    wake.wait(guard, [&]{ return quit  or  generation != seenGeneration; });
+                    if (quit){ return; }
+                    seenGeneration = generation;
+                }
+                work(worker);
+            }
+        }
+        
+        public : 
+        
+        JobSystem(unsigned int workerCount) : queues(std::max(1U, workerCount)) {
+            generation = 0;  quit = false;  jobsLeft = 0;
+            for (auto &queue : queues){ queue.jobs.reserve(MAX_BATCHES_PER_WORKER); }
+            for (unsigned int w = 1; w < queues.size(); ++w){ threads.emplace_back(&JobSystem::workerLoop, this, w); }
+        }
+        ~JobSystem() noexcept {
+            { std::lock_guard<std::mutex> guard(wakeLock);  quit = true; }
+            wake.notify_all();
+            for (auto &thread : threads){ thread.join(); }
+        }
+        JobSystem(const JobSystem &) = delete;
+        JobSystem& operator=(const JobSystem &) = delete;
+        
+        inline unsigned int getWorkerCount() const { return static_cast<unsigned int>(queues.size()); }
+        
+        // calls (body)(begin, end, worker) for batches of at least (grain) indices which cover [0, count),
+        // (worker) is the index of the running worker so the body can write into per worker buffers,
+        // it returns when all the batches are done, small loops run directly on the calling thread
+        template <typename Body>
+        void parallelFor(std::size_t count, std::size_t grain, const Body &body){
+            
+            if (queues.size() == 1  or  count <= grain){ if (count > 0){ body(0, count, 0U); } return; }
+            
+            std::size_t batches = std::min((count + grain - 1) / grain, queues.size() * MAX_BATCHES_PER_WORKER);
+            std::size_t batchSize = (count + batches - 1) / batches;
+            batches = (count + batchSize - 1) / batchSize;
+            auto run = [](const void *loop, std::size_t begin, std::size_t end, unsigned int worker){
+                (*static_cast<const Body *>(loop))(begin, end, worker);
+            };
+            
+            jobsLeft.store(batches, std::memory_order_relaxed);
+            for (std::size_t b = 0; b < batches; ++b){
+                WorkQueue &queue = queues[b % queues.size()];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                if (queue.head == queue.jobs.size()){ queue.jobs.clear();  queue.head = 0; }
+                queue.jobs.push_back(Job{ b * batchSize, std::min(count, (b + 1) * batchSize), run, &body });
+            }
+            { std::lock_guard<std::mutex> guard(wakeLock);  ++generation; }
+            wake.notify_all();
+            
+            work(0);
+            // the other workers may still run the batches they have taken
+            std::unique_lock<std::mutex> guard(wakeLock);
+            done.wait(guard, [&]{ return jobsLeft.load(std::memory_order_acquire) == 0; });
+        }
+    };
+    
+    
+    ////////////////////////////////// @c FRAME-PROFILER //////////////////////////////////
+    
+    
+    // the parts of a frame which are timed, the ones inside (TICK_PHASE) are the parts of the simulation
+    enum ProfilePhase : std::uint8_t { 
+        INPUT_PHASE, TICK_PHASE, FIRE_AND_MOVE_PHASE, COLLISION_PHASE, CLEANUP_PHASE, UPDATE_PHASE, WAVE_PHASE, 
+        SOUND_PHASE, DRAW_PHASE, PRESENT_PHASE, PROFILE_PHASES 
+    };
+    const char *const PROFILE_PHASE_NAMES[PROFILE_PHASES] = { 
+        "input", "tick", "fire and move", "collision", "cleanup", "update", "wave spawn", "sound", "draw", "present" 
+    };
+    
+#ifdef ASTEROID_PROFILE
+    
+    class Profiler { // collects the time of each phase per frame, and optionally every timing for a trace file
+        
+        private : 
+        
+        using Clock = std::chrono::steady_clock;
+        struct TraceEvent { std::int64_t start, duration;  std::uint8_t phase; };
+        struct TraceCounter { std::int64_t time;  std::uint32_t objects[ENTITY_TYPES]; };
+        
+        Clock::time_point origin, markStart;
+        ProfilePhase markPhase;
+        bool markOpen;
+        double frameMs[PROFILE_PHASES], lastFrameMs[PROFILE_PHASES], averageMs[PROFILE_PHASES];
+        std::uint32_t lastObjects[ENTITY_TYPES];
+        std::vector<TraceEvent> events;
+        std::vector<TraceCounter> counters;
+        std::size_t maxEvents;
+        std::uint64_t frames, eventsDropped;
+        /*
+        markPhase    : the phase started by the last (mark), it runs until the next mark or (endMark)
+        frameMs      : the time of each phase in the current frame, (lastFrameMs) of the finished frame
+        averageMs    : a running average of the frame times, it is steadier to read on the overlay
+        events       : the timings kept for the trace file (nothing is kept when no trace was asked for),
+                       it is allocated once and the timings beyond (maxEvents) are dropped
+        */
+        inline std::int64_t nanosecondsOf(Clock::time_point time) const { 
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count(); 
+        }
+        
+        public : 
+        
+        Profiler() noexcept {
+            origin = markStart = Clock::now();  markPhase = INPUT_PHASE;  markOpen = false;
+            std::fill_n(frameMs, PROFILE_PHASES, 0.0);  std::fill_n(lastFrameMs, PROFILE_PHASES, 0.0);
+            std::fill_n(averageMs, PROFILE_PHASES, 0.0);  std::fill_n(lastObjects, ENTITY_TYPES, 0U);
+            maxEvents = 0;  frames = eventsDropped = 0;
+        }
+        ~Profiler() noexcept {}
+        
+        // keep up to (maxTraceEvents) timings for (writeTrace)
+        void enableTrace(std::size_t maxTraceEvents){
+            maxEvents = maxTraceEvents;
+            events.reserve(maxEvents);  counters.reserve(maxEvents / 8);
+        }
+        
+        void record(ProfilePhase phase, Clock::time_point start, Clock::time_point end){
+            frameMs[phase] += std::chrono::duration<double, std::milli>(end - start).count();
+            if (maxEvents == 0){ return; }
+            if (events.size() == maxEvents){ ++eventsDropped;  return; }
+            events.push_back(TraceEvent{ nanosecondsOf(start), nanosecondsOf(end) - nanosecondsOf(start), phase });
+        }
+        // phase markers : the code between two marks belongs to the phase of the first one
+        void mark(ProfilePhase phase){
+            Clock::time_point now = Clock::now();
+            if (markOpen){ record(markPhase, markStart, now); }
+            markPhase = phase;  markStart = now;  markOpen = true;
+        }
+        void endMark(){
+            if (markOpen){ record(markPhase, markStart, Clock::now());  markOpen = false; }
+        }
+        
+        // closes a frame, the object counts are shown next to the phase times
+        void endFrame(const EntityStore &store){
+            for (short int p = 0; p < PROFILE_PHASES; ++p){
+                lastFrameMs[p] = frameMs[p];   frameMs[p] = 0.0;
+                averageMs[p] += (lastFrameMs[p] - averageMs[p]) * ((frames == 0)? 1.0 : 0.05);
+            }
+            for (auto type : { SPACESHIP, BULLET, ASTEROID, EXPLOSION, HUNTER }){ lastObjects[type] = store[type].size(); }
+            if (maxEvents > 0  and  counters.size() < counters.capacity()){
+                counters.push_back(TraceCounter{ nanosecondsOf(Clock::now()), {} });
+                std::copy_n(lastObjects, ENTITY_TYPES, counters.back().objects);
+            }
+            ++frames;
+        }
+        
+        // the text of the on screen overlay
+        std::string overlayText() const {
+            char line[96];  std::string text = "phase (ms)       last     average\n";
+            for (short int p = 0; p < PROFILE_PHASES; ++p){
+                std::snprintf(line, sizeof(line), "%-14s %7.3f  %7.3f\n", PROFILE_PHASE_NAMES[p], lastFrameMs[p], averageMs[p]);
+                text += line;
+            }
+            std::snprintf(line, sizeof(line), "bullets %u  asteroids %u  explosions %u", 
+                            lastObjects[BULLET], lastObjects[ASTEROID], lastObjects[EXPLOSION]);
+            return text + line;
+        }
+        
+        // writes the kept timings as a Chrome trace event file (chrome://tracing, Perfetto)
+        bool writeTrace(const std::string &fileName) const {
+            std::ofstream file(fileName);
+            if (not file){ return false; }
+            file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"game\"}}";
+            char line[192];
+            for (const auto &event : events){
+                std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                                PROFILE_PHASE_NAMES[event.phase], event.start / 1000.0, event.duration / 1000.0);
+                file << line;
+            }
+            for (const auto &counter : counters){
+                std::snprintf(line, sizeof(line), ",\n{\"name\":\"objects\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,"
+                                "\"args\":{\"bullets\":%u,\"asteroids\":%u,\"explosions\":%u,\"hunters\":%u}}", counter.time / 1000.0, 
+                                counter.objects[BULLET], counter.objects[ASTEROID], counter.objects[EXPLOSION], counter.objects[HUNTER]);
+                file << line;
+            }
+            file << "\n],\"otherData\":{\"frames\":" << frames << ",\"eventsDropped\":" << eventsDropped << "}}\n";
+            return static_cast<bool>(file);
+        }
+    };
+    
+    Profiler profiler;
+    
+    class ProfileScope { // times the scope it is declared in
+        ProfilePhase phase;  std::chrono::steady_clock::time_point start;
+        public : 
+        ProfileScope(ProfilePhase timedPhase) noexcept : phase(timedPhase), start(std::chrono::steady_clock::now()) {}
+        ~ProfileScope() noexcept { profiler.record(phase, start, std::chrono::steady_clock::now()); }
+    };
+    
+#define ASTEROID_PROFILE_CONCAT2(a, b) a##b
+#define ASTEROID_PROFILE_CONCAT(a, b) ASTEROID_PROFILE_CONCAT2(a, b)
+#define ASTEROID_PROFILE_SCOPE(phase) Asteroid::ProfileScope ASTEROID_PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define ASTEROID_PROFILE_MARK(phase)  Asteroid::profiler.mark(phase)
+#define ASTEROID_PROFILE_END_MARK()   Asteroid::profiler.endMark()
+#define ASTEROID_PROFILE_FRAME(store) Asteroid::profiler.endFrame(store)
+    
+#else // without ASTEROID_PROFILE every profiling statement compiles to nothing
+    
+#define ASTEROID_PROFILE_SCOPE(phase)
+#define ASTEROID_PROFILE_MARK(phase)
+#define ASTEROID_PROFILE_END_MARK()
+#define ASTEROID_PROFILE_FRAME(store)
+    
+#endif // ASTEROID_PROFILE
+    
+    
+    ////////////////////////////////// @c TIMER-WHEEL //////////////////////////////////
+    
+    
+    enum TimerKind : std::uint8_t { INPUT_UNBLOCK_TIMER, FIRE_RECHARGE_TIMER, EXPLOSION_END_TIMER, BULLET_EXPIRY_TIMER, NEXT_WAVE_TIMER, TIMER_KINDS };
+    
+    // something that happens at tick (due) : (entity) is the bullet or the explosion it ends, (since) the tick the
+    // timed state started, a timer whose state was started again or whose entity is gone does nothing
+    struct Timer { 
+        std::uint64_t due, since;  EntityHandle entity;  std::uint32_t next;  TimerKind kind; 
+        // the saved fields, (next) is where the timer is in the wheel, a loaded timer is scheduled again
+        template <typename Stream, typename Self> static void fields(Stream &io, Self &timer){
+            io.field(timer.due);   io.field(timer.since);   io.field(timer.entity);   io.field(timer.kind);
+        }
+    };
+    
+    const int WHEEL_LEVELS = 4, WHEEL_BITS = 8, WHEEL_SLOTS = 1 << WHEEL_BITS;
+    const std::uint32_t NO_TIMER = UINT32_MAX;
+    
+    class TimerWheel { // hierarchical timing wheels : inserting and expiring a timer is O(1) however many are waiting
+        
+        private : 
+        
+        std::vector<Timer> timers;
+        std::vector<std::uint32_t> freeTimers;
+        std::uint32_t slots[WHEEL_LEVELS][WHEEL_SLOTS];
+        std::uint64_t now;
+        std::size_t waiting;
+        /*
+        timers      : the timer nodes, the timers of a slot are linked through (next), the unused ones are in (freeTimers)
+        slots       : level 0 has a slot for each of the next 256 ticks, a slot of level L covers 256^L ticks; a timer
+                      further away than its level waits in a higher level, when the ticks reach its slot the timers
+                      of that slot move down a level (cascade), so each timer moves at most WHEEL_LEVELS times
+        now         : the last tick that expired
+        */
+        
+        // puts timer (t) into the slot of its due tick, at the lowest level which reaches that far
+        void place(std::uint32_t t){
+            std::uint64_t due = timers[t].due, distance = due - now;
+            int level = 0;
+            while (level + 1 < WHEEL_LEVELS  and  distance >= (1ULL << (WHEEL_BITS * (level + 1)))){ ++level; }
+            // beyond the last level a timer waits in its last slot and is placed again when that cascades
+            if (distance >= (1ULL << (WHEEL_BITS * WHEEL_LEVELS))){ due = now + (1ULL << (WHEEL_BITS * WHEEL_LEVELS)) - 1; }
+            std::uint32_t &head = slots[level][(due >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+            timers[t].next = head;   head = t;
+        }
+        // moves the timers of a slot of a higher level down to the levels of their remaining distance
+        void cascade(int level){
+            std::uint32_t &head = slots[level][(now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+            std::uint32_t t = head;
+            head = NO_TIMER;
+            while (t != NO_TIMER){ std::uint32_t next = timers[t].next;  place(t);  t = next; }
+        }
+        
+        public : 
+        
+        TimerWheel() noexcept { now = 0;  waiting = 0;  reset(0); }
+        ~TimerWheel() noexcept {}
+        
+        // room for (maxTimers) waiting at once, more timers grow the nodes
+        void reserve(std::size_t maxTimers){ timers.reserve(maxTimers);  freeTimers.reserve(maxTimers); }
+        
+        // no timers, (tick) is the last tick that expired
+        void reset(std::uint64_t tick){
+            for (auto &level : slots){ std::fill_n(level, WHEEL_SLOTS, NO_TIMER); }
+            timers.clear();   freeTimers.clear();
+            now = tick;   waiting = 0;
+        }
+        
+        // a timer of (kind) at tick (due), a due tick which already expired fires with the next tick
+        void schedule(TimerKind kind, std::uint64_t due, std::uint64_t since, EntityHandle entity = EntityHandle()){
+            std::uint32_t t;
+            if (not freeTimers.empty()){ t = freeTimers.back();  freeTimers.pop_back(); }
+            else { t = static_cast<std::uint32_t>(timers.size());  timers.emplace_back(); }
+            timers[t] = Timer{ std::max(due, now + 1), since, entity, NO_TIMER, kind };
+            place(t);
+            ++waiting;
+        }
+        
+        // expires the ticks up to (tick), calls (fire) with every timer due in them, tick by tick
+        template <typename Handler>
+        void advance(std::uint64_t tick, Handler &&fire){
+            while (now < tick){
+                ++now;
+                // a level cascades when all the slots of the level below went round once, the highest first
+                for (int level = WHEEL_LEVELS - 1; level > 0; --level){
+                    if ((now & ((1ULL << (WHEEL_BITS * level)) - 1)) == 0){ cascade(level); }
+                }
+                std::uint32_t &head = slots[0][now & (WHEEL_SLOTS - 1)];
+                std::uint32_t t = head;
+                head = NO_TIMER; // the timers scheduled by (fire) go to other slots
+                while (t != NO_TIMER){
+                    std::uint32_t next = timers[t].next;
+                    if (timers[t].due == now){ 
+                        Timer timer = timers[t];
+                        freeTimers.push_back(t);   --waiting;
+                        fire(timer); 
+                    }
+                    else { place(t); } // a timer further away than the last level
+                    t = next;
+                }
+            }
+        }
+        
+        inline std::size_t size() const { return waiting; }
+        
+        // the waiting timers, a loaded wheel schedules them again (the order of the timers of one tick does not matter)
+        void save(SaveWriter &out) const {
+            out.field(now);   out.field(static_cast<std::uint64_t>(waiting));
+            for (const auto &level : slots){
+                for (auto head : level){ for (std::uint32_t t = head; t != NO_TIMER; t = timers[t].next){ Timer::fields(out, timers[t]); } }
+            }
+        }
+        bool load(SaveReader &in){
+            std::uint64_t tick = 0;
+            in.field(tick);
+            std::size_t count = in.count(savedBytes<Timer>());
+            reset(tick);
+            for (std::size_t i = 0; i < count  and  in.isValid(); ++i){
+                Timer timer{};
+                Timer::fields(in, timer);
+                if (timer.kind >= TIMER_KINDS  or  timer.due <= tick){ in.fail(); }
+                else { schedule(timer.kind, timer.due, timer.since, timer.entity); }
+            }
+            if (not in.isValid()){ reset(0);  return false; }
+            return true;
+        }
+    };
+    
+    
+    ////////////////////////////////// @c GAME-WORLD //////////////////////////////////
+    
+    
+    // the player inputs for one tick (also the keys which were pressed since the last tick)
+    struct TickInput { 
+        bool rotateLeft = false, rotateRight = false, thrust = false;
+        bool fireSingle = false, changeFireType = false, continiousFire = false;
+    };
+    // what happened during one tick, so the window and the sounds can react to it
+    struct TickEvents { 
+        bool singleFired = false, continiousFired = false, shipHit = false, newWave = false, gameOver = false; 
+    };
+    
+    // the fixed number of entities each pool can hold, spawns beyond it are dropped
+    const std::size_t POOL_CAPACITY[ENTITY_TYPES] = { 1, 4096, 16384, 2048, 1024 };
+    
+    // a bullet against asteroid collision found by a worker, (order) counts the hits of the same bullet
+    struct BulletHit { std::uint32_t bullet, order, rock; };
+    // the collisions found by one worker during a tick (aligned so two workers never share a cache line)
+    struct alignas(64) WorkerHits { std::vector<BulletHit> hits;  unsigned long candidatePairs = 0; };
+    
+    const std::size_t UPDATE_GRAIN = 1024; // the smallest batch of entities given to a worker
+    const std::size_t PARTICLE_CAPACITY = 16384, MAX_BURSTS_PER_TICK = 4096;
+    
+    inline std::uint64_t ticksOf(float seconds){ return static_cast<std::uint64_t>(seconds * simulationRate + 0.5F); }
+    
+    const float BULLET_TTL = 2.0F, WAVE_DELAY = 1.0F; // seconds a bullet flies at most, and between two waves
+    
+    
+    ////////////////////////////////// @c STRESS-SCENARIOS //////////////////////////////////
+    
+    
+    enum ScenarioCommand : std::uint8_t { SPAWN_BIG_ROCKS, SPAWN_SMALL_ROCKS, BULLET_STORM, SET_FIRE_TYPE, SET_WAVES, SPAWN_HUNTERS };
+    
+    // one line of a scenario, (count) is the entity count, the fire type or 0/1 for the waves off/on
+    struct ScenarioEvent { float seconds;  ScenarioCommand command;  int count;  float minSpeed, maxSpeed; };
+    
+    class Scenario { // a schedule of spawns read from a text file, so a profile can start right at a heavy load
+        
+        private : 
+        
+        std::vector<ScenarioEvent> events;
+        /*
+        events      : sorted by time, the events of the same time keep the order of the file
+        
+        file format : "asteroid-scenario 1", then one event per line, "#" starts a comment
+                      <seconds> rocks big|small <count> <min speed> <max speed>
+                      <seconds> bullets <count>        a storm of bullets from random points in random directions
+                      <seconds> hunters <count>        hunters around the ship, they chase it along the flow field
+                      <seconds> fire-type 1|2|3
+                      <seconds> waves on|off          the normal waves start whenever the ship is alone (default on)
+        the speeds are per axis and reference tick, each axis gets a random sign, at most ASTEROID_MAX_SPEED
+        */
+        public : 
+        
+        Scenario() noexcept {}
+        ~Scenario() noexcept {}
+        
+        // reads a scenario file, an invalid line is reported with its number and fails the whole file
+        bool load(const std::string &file){
+            std::ifstream in(file);
+            std::string line, word;  int version = 0, lineNo = 1;
+            if (not std::getline(in, line)  or  not (std::istringstream(line) >> word >> version)  
+                or  word != "asteroid-scenario"  or  version != 1){ 
+                std::cerr << file << " is not an asteroid-scenario 1 file\n";  return false; 
+            }
+            while (std::getline(in, line)){
+                ++lineNo;
+                line = line.substr(0, line.find('#'));
+                std::istringstream fields(line);
+                ScenarioEvent event{ 0.0F, SPAWN_BIG_ROCKS, 0, 0.0F, 0.0F };
+                if (not (fields >> event.seconds)){ continue; } // an empty line
+                
+                bool valid = (fields >> word)  and  event.seconds >= 0.0F;
+                if (valid  and  word == "rocks"){
+                    valid = (fields >> word >> event.count >> event.minSpeed >> event.maxSpeed)  and  (word == "big"  or  word == "small")
+                            and  event.count >= 0  and  0.0F <= event.minSpeed  and  event.minSpeed <= event.maxSpeed  
+                            and  event.maxSpeed <= ASTEROID_MAX_SPEED;
+                    event.command = (word == "big")? SPAWN_BIG_ROCKS : SPAWN_SMALL_ROCKS;
+                }
+                else if (valid  and  word == "bullets"){ 
+                    event.command = BULLET_STORM;
+                    valid = (fields >> event.count)  and  event.count >= 0; 
+                }
+                else if (valid  and  word == "hunters"){ 
+                    event.command = SPAWN_HUNTERS;
+                    valid = (fields >> event.count)  and  event.count >= 0; 
+                }
+                else if (valid  and  word == "fire-type"){ 
+                    event.command = SET_FIRE_TYPE;
+                    valid = (fields >> event.count)  and  1 <= event.count  and  event.count <= 3; 
+                }
+                else if (valid  and  word == "waves"){ 
+                    event.command = SET_WAVES;
+                    valid = (fields >> word)  and  (word == "on"  or  word == "off");
+                    event.count = (word == "on");
+                }
+                else { valid = false; }
+                
+                if (not valid  or  (fields >> word)){ std::cerr << file << " line " << lineNo << " is not a valid event\n";  return false; }
+                events.push_back(event);
+            }
+            std::stable_sort(events.begin(), events.end(), [](const ScenarioEvent &e1, const ScenarioEvent &e2){ 
+                return e1.seconds < e2.seconds; 
+            });
+            return true;
+        }
+        inline const std::vector<ScenarioEvent>& getEvents() const { return events; }
+        
+        // the most entities of a type the schedule can have alive at once (every big asteroid breaks into 4)
+        std::size_t entitiesNeeded(EntityType type) const {
+            std::size_t needed = 0;
+            for (const auto &event : events){
+                if (type == ASTEROID  and  event.command == SPAWN_BIG_ROCKS){ needed += event.count * 4; }
+                if (type == ASTEROID  and  event.command == SPAWN_SMALL_ROCKS){ needed += event.count; }
+                if (type == BULLET  and  event.command == BULLET_STORM){ needed += event.count; }
+                if (type == HUNTER  and  event.command == SPAWN_HUNTERS){ needed += event.count; }
+            }
+            return needed;
+        }
+    };
+    
+    
+    class World { // the complete game simulation, it never touches the window, the sounds or the files
+        
+        public : 
+        
+        EntityStore gameObjs;
+        EntityHandle spaceshipObj;
+        SpatialHash broadphase, hunterBroadphase;
+        const AnimationClip *clips;
+        JobSystem jobs;
+        std::vector<WorkerHits> workerHits;
+        std::vector<BulletHit> bulletHits;
+        ParticleSystem particles;
+        ChunkGrid chunks;
+        FlowField flow;
+        TimerWheel timers;
+        std::uint64_t explosionTicks;
+        const Scenario *scenario;
+        const RockHulls *hulls;
+        std::size_t nextScenarioEvent;
+        
+        short int playerHealthCount, playerScore, waveLength, waveNo;
+        bool inputBlocked, continiousFireOn, holdFire, wavesOn, wavePending;
+        std::uint64_t tickNo, inputBlockedTick, fireStartTick, fireHoldTick;
+        float fireCredit;
+        unsigned long candidatePairs;
+        std::uint64_t tickAllocations;
+        /*
+        clips          : the animation clips of all the objects (indexed by AnimationId)
+        jobs           : runs the updates and the collision queries of the big pools in parallel batches
+        workerHits     : the collisions each worker found, they are merged into (bulletHits) in bullet order
+                         and applied by one thread, so the game plays the same with any number of threads
+        particles      : the explosions of the asteroids, only drawn, they never change how the game plays
+        chunks         : a large world (--world-screens) keeps the asteroids far from the ship asleep outside of the pools
+        flow           : the way to the ship around the big asteroids, the hunters read it, a worker thread builds the next one
+        hunterBroadphase: the hunters, the bullets are tested against them like against the asteroids
+        timers         : the rules which end after some time (the input block, the fire recharge, the explosions, the 
+                         bullets and the pause before a wave) are scheduled when they start and fire on their tick
+        explosionTicks : the ticks the explosion of the ship plays before it ends
+        scenario       : a spawn schedule played by the ticks (or nullptr), (nextScenarioEvent) is its next event
+        hulls          : the hit shapes of the asteroid frames (or nullptr, then the asteroids are circles)
+        wavesOn        : the normal waves, a scenario can turn them off, (wavePending) the next one is scheduled
+        tickNo         : ticks simulated so far, the timers below are the tick numbers when they started
+        fireCredit     : one continious bullet is fired per reference tick, this collects the tick parts
+        candidatePairs : pairs sent to the narrowphase (sweptHitMask and isCollided) in the last tick
+        tickAllocations: heap allocations made by the last tick (only counted with ASTEROID_COUNT_ALLOCATIONS)
+        */
+        // the broadphase cells are the largest (R1 + R2), 40 for the spaceship against a big asteroid, or the spaceship
+        // against the circle around the largest asteroid hull
+        World(const AnimationClip *animationClips, unsigned int threads = workerThreads, const Scenario *stressScenario = nullptr,
+              const RockHulls *asteroidHulls = nullptr) 
+            : broadphase(std::max(40.0F, 20.0F + (asteroidHulls? asteroidHulls->getMaxRadius() : 0.0F))), hunterBroadphase(40.0F), 
+              jobs(threads), workerHits(jobs.getWorkerCount()), particles(PARTICLE_CAPACITY, MAX_BURSTS_PER_TICK) {
+            clips = animationClips;   scenario = stressScenario;   hulls = asteroidHulls;
+            candidatePairs = 0;  tickAllocations = 0;
+            
+            // all the memory of the game objects is allocated here, the ticks only recycle it
+            for (auto type : { SPACESHIP, BULLET, ASTEROID, EXPLOSION, HUNTER }){
+                gameObjs.reserve(type, POOL_CAPACITY[type]);
+            }
+            // the stress benchmarks grow the waves by more than 5, the asteroids of their last wave
+            // and all the pieces of them need a larger pool
+            std::size_t stressRocks = static_cast<std::size_t>(waveStep) * benchmarkWaves * 4;
+            if (stressRocks > POOL_CAPACITY[ASTEROID]){ gameObjs.reserve(ASTEROID, stressRocks); }
+            // and so does a scenario, all of its spawns can be alive at once on top of the normal waves
+            for (auto type : { BULLET, ASTEROID, HUNTER }){
+                std::size_t needed = (scenario != nullptr)? gameObjs[type].capacity() + scenario->entitiesNeeded(type) : 0;
+                if (needed > POOL_CAPACITY[type]){ gameObjs.reserve(type, needed); }
+            }
+            reserveHunters();
+            broadphase.reserve(gameObjs[ASTEROID].capacity(), worldW, worldH);
+            flow.reserve(gameObjs[ASTEROID].capacity());
+            for (auto &worker : workerHits){ worker.hits.reserve(gameObjs[BULLET].capacity()); }
+            bulletHits.reserve(gameObjs[BULLET].capacity() * 2);
+            // a timer for every bullet and every explosion, and the few timers of the rules
+            timers.reserve(gameObjs[BULLET].capacity() + gameObjs[EXPLOSION].capacity() + TIMER_KINDS);
+            
+            // the playhead of the explosion steps like in updateAnimations, it ends in the tick its next step would wrap
+            // (a clip which never wraps is cut after 10 seconds)
+            float playhead = 0.0F;
+            const AnimationClip &explosionClip = clips[SHIP_EXPLOSION_ANIM];
+            for (explosionTicks = 0; not explosionClip.isEnd(playhead, tickScale)  and  explosionTicks < ticksOf(10); ++explosionTicks){ 
+                playhead = explosionClip.advance(playhead, tickScale); 
+            }
+            restart();
+        }
+        ~World() noexcept {}
+        
+        inline std::size_t ship() const { return gameObjs.indexOf(spaceshipObj); }
+        
+        // the hunters of the last wave of a benchmark are alive at once, a resumed session with another
+        // (huntersPerWave) reserves them again
+        void reserveHunters(){
+            std::size_t benchmarkHunters = static_cast<std::size_t>(huntersPerWave) * benchmarkWaves;
+            if (benchmarkHunters > gameObjs[HUNTER].capacity()){ gameObjs.reserve(HUNTER, benchmarkHunters); }
+            hunterBroadphase.reserve(gameObjs[HUNTER].capacity(), worldW, worldH);
+        }
+        
+        // the state of a new game, only the ship is there
+        void restart(){
+            nextScenarioEvent = 0;
+            playerHealthCount = 5;  playerScore = waveLength = waveNo = 0;
+            inputBlocked = continiousFireOn = holdFire = wavePending = false;   wavesOn = true;
+            tickNo = inputBlockedTick = fireStartTick = fireHoldTick = 0;
+            fireCredit = 0.0F;
+            gameObjs.clear();   particles.clear();   chunks.reset(screenW, screenH); // a chunk is one screen
+            flow.reset();   timers.reset(0);
+            
+            // space ship obj, the handle finds the ship inside its pool
+            spaceshipObj = gameObjs.spawn(SPACESHIP, SPACESHIP_ANIM, 400, 400, 0, 20);
+        }
+        
+        // the counters and the timers of the rules, then the entities and the particles; the scenario
+        // is not saved, only how far it was played
+        void save(SaveWriter &out) const {
+            out.field(spaceshipObj);
+            out.field(playerHealthCount);   out.field(playerScore);        out.field(waveLength);   out.field(waveNo);
+            out.field(inputBlocked);        out.field(continiousFireOn);   out.field(holdFire);     out.field(wavesOn);
+            out.field(tickNo);              out.field(inputBlockedTick);   out.field(fireStartTick);  out.field(fireHoldTick);
+            out.field(fireCredit);          out.field(static_cast<std::uint64_t>(nextScenarioEvent));   out.field(wavePending);
+            gameObjs.save(out);   particles.save(out);   chunks.save(out);   flow.save(out);   timers.save(out);
+        }
+        // returns false for a broken save, the world is a new game then
+        bool load(SaveReader &in){
+            std::uint64_t scenarioEvent = 0;
+            in.field(spaceshipObj);
+            in.field(playerHealthCount);    in.field(playerScore);         in.field(waveLength);    in.field(waveNo);
+            in.field(inputBlocked);         in.field(continiousFireOn);    in.field(holdFire);      in.field(wavesOn);
+            in.field(tickNo);               in.field(inputBlockedTick);    in.field(fireStartTick);   in.field(fireHoldTick);
+            in.field(fireCredit);           in.field(scenarioEvent);      in.field(wavePending);
+            nextScenarioEvent = static_cast<std::size_t>(scenarioEvent);
+            
+            bool loaded = in.isValid()  and  gameObjs.load(in)  and  particles.load(in)  and  chunks.load(in)  and  flow.load(in)  and  timers.load(in)
+                          and  gameObjs.isValid(spaceshipObj)
+                          and  gameObjs[SPACESHIP].size() == 1  and  gameObjs[SPACESHIP].handleSlot[0] == spaceshipObj.slot;
+            if (not loaded){ restart(); }
+            return loaded;
+        }
+        
+        // a bullet lives until it leaves the screen or (BULLET_TTL) is over
+        void spawnBullet(AnimationId clip, float x, float y, float angle, float R){
+            timers.schedule(BULLET_EXPIRY_TIMER, tickNo + ticksOf(BULLET_TTL), tickNo, gameObjs.spawn(BULLET, clip, x, y, angle, R));
+        }
+        
+        // create asteroid objects randomly based on wave format
+        void spawnWave(){
+            waveLength += waveStep; // increase the wave length whenever player clears a wave successfully
+            waveNo++;               // track the wave no.
+            
+            std::uniform_real_distribution<float> placeX(0.0F, worldW), placeY(0.0F, worldH);
+            for (short int i = 0; i < waveLength; ++i){
+                if (chunks.isLarge()){ // spread over the whole large world, the far ones fall asleep in the next tick
+                    float x = placeX(randGen), y = placeY(randGen);
+                    spawnAsteroid(gameObjs, BIG_ASTEROID_ANIM, x, y, randNo(randGen) % 360, 20);
+                    continue;
+                }
+                spawnAsteroid(gameObjs, BIG_ASTEROID_ANIM, randNo(randGen) % static_cast<int>(worldW), 
+                                randNo(randGen) % static_cast<int>(worldH), randNo(randGen) % 360, 20);
+            }
+            spawnHunters(static_cast<int>(huntersPerWave) * waveNo);
+        }
+        
+        // spawns hunters in a ring around the ship, far enough away to be seen coming
+        void spawnHunters(int count){
+            const EntityPool &ships = gameObjs[SPACESHIP];
+            std::uniform_real_distribution<float> degree(0.0F, 360.0F), distance(350.0F, 550.0F);
+            for (int i = 0; i < count; ++i){
+                float angle = degree(randGen), away = distance(randGen);
+                float x = std::fmod(ships.x[ship()] + tableCos(angle) * away + worldW, worldW);
+                float y = std::fmod(ships.y[ship()] + tableSin(angle) * away + worldH, worldH);
+                gameObjs.spawn(HUNTER, HUNTER_ANIM, x, y, angle + 180.0F, HUNTER_RADIUS);
+            }
+        }
+        
+        // spawns the entities of a scenario event at random places (from the game random numbers, so a 
+        // scenario with a seed plays the same every time) or changes the settings it names
+        void playScenarioEvent(const ScenarioEvent &event){
+            std::uniform_real_distribution<float> placeX(0.0F, worldW), placeY(0.0F, worldH), degree(0.0F, 360.0F);
+            std::uniform_real_distribution<float> speed(event.minSpeed, event.maxSpeed);
+            auto signedSpeed = [&](){ float v = speed(randGen);  return (randGen() & 1)? -v : v; };
+            
+            switch (event.command){
+                case SPAWN_BIG_ROCKS :
+                case SPAWN_SMALL_ROCKS : {
+                    bool big = (event.command == SPAWN_BIG_ROCKS);
+                    for (int i = 0; i < event.count; ++i){
+                        float x = placeX(randGen), y = placeY(randGen), angle = degree(randGen);
+                        float velX = signedSpeed(), velY = signedSpeed();
+                        gameObjs.spawn(ASTEROID, big? BIG_ASTEROID_ANIM : SMALL_ASTEROID_ANIM, x, y, angle, big? 20 : 10, velX, velY);
+                    }
+                    break;
+                }
+                case BULLET_STORM : 
+                    for (int i = 0; i < event.count; ++i){
+                        float x = placeX(randGen), y = placeY(randGen), angle = degree(randGen);
+                        spawnBullet((fireType == 1)? BLUE_BULLET_ANIM : RED_BULLET_ANIM, x, y, angle, 11);
+                    }
+                    break;
+                case SET_FIRE_TYPE : fireType = static_cast<short int>(event.count);  break;
+                case SET_WAVES :     wavesOn = (event.count != 0);  break;
+                case SPAWN_HUNTERS : spawnHunters(event.count);  break;
+            }
+        }
+        
+        // a hash of the positions and the velocities of all the objects and the game counters, two runs
+        // which played the same game end with bit identical floats and so with the same checksum
+        std::uint64_t checksum() const {
+            std::uint64_t hash = 1469598103934665603ULL; // FNV-1a
+            auto mix = [&](const void *data, std::size_t bytes){
+                for (std::size_t i = 0; i < bytes; ++i){ hash = (hash ^ static_cast<const std::uint8_t *>(data)[i]) * 1099511628211ULL; }
+            };
+            for (auto type : { SPACESHIP, BULLET, ASTEROID, EXPLOSION, HUNTER }){
+                const EntityPool &pool = gameObjs[type];
+                for (auto *field : { &pool.x, &pool.y, &pool.dx, &pool.dy, &pool.angle }){ mix(field->data(), pool.size() * sizeof(float)); }
+            }
+            chunks.forEachSleeper([&](const SleepingRock &rock){ mix(&rock.x, sizeof(float) * 4); }); // x, y, dx, dy
+            mix(&playerScore, sizeof(playerScore));  mix(&playerHealthCount, sizeof(playerHealthCount));  mix(&tickNo, sizeof(tickNo));
+            return hash;
+        }
+        
+        void tick(const TickInput &input, TickEvents &events){
+            
+            EntityPool &ships = gameObjs[SPACESHIP],  &bullets    = gameObjs[BULLET];
+            EntityPool &rocks = gameObjs[ASTEROID],   &explosions = gameObjs[EXPLOSION];
+            EntityPool &hunters = gameObjs[HUNTER];
+            std::size_t ship = this->ship();
+#ifdef ASTEROID_COUNT_ALLOCATIONS
+            std::uint64_t allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
+#endif
+            
+            ASTEROID_PROFILE_SCOPE(TICK_PHASE);
+            ASTEROID_PROFILE_MARK(FIRE_AND_MOVE_PHASE);
+            for (auto type : { SPACESHIP, BULLET, ASTEROID, EXPLOSION, HUNTER }){ savePreviousState(gameObjs[type]); }
+            ++tickNo;
+            
+            // the timers due in this tick, a timer of a state started again since or of an entity removed since does nothing
+            timers.advance(tickNo, [&](const Timer &timer){
+                switch (timer.kind){
+                    // released the input flag and again allow keyboard inputs after holding for 1/2 seconds
+                    case INPUT_UNBLOCK_TIMER : if (timer.since == inputBlockedTick){ inputBlocked = false; }  break;
+                    // restart the continious fire after recharged for 10 seconds
+                    case FIRE_RECHARGE_TIMER : if (timer.since == fireHoldTick){ holdFire = false; }  break;
+                    case EXPLOSION_END_TIMER : 
+                    case BULLET_EXPIRY_TIMER : if (gameObjs.isValid(timer.entity)){ gameObjs.kill(timer.entity); }  break;
+                    case NEXT_WAVE_TIMER :     
+                        wavePending = false; 
+                        if (wavesOn){ spawnWave();  events.newWave = true; }  
+                        break;
+                    default : break;
+                }
+            });
+            
+            
+            ////////////////////////// @c DIFFERENT-TYPE-BULLET-SHOOT-LOGIC /////////////////////////
+            
+            
+            if (input.fireSingle  and  not inputBlocked){ 
+                // create a new single bullet obj on space key input
+                spawnBullet(BLUE_BULLET_ANIM, ships.x[ship], ships.y[ship], ships.angle[ship], 10);
+                events.singleFired = true;
+            }
+            // changes the fire type upon keyboard down key press
+            if (input.changeFireType){ ++fireType;  if (fireType >= 4) fireType = 1; }
+            
+            // shift hold for continious fire
+            if (input.continiousFire  and  not continiousFireOn){ fireStartTick = tickNo; }
+            continiousFireOn = input.continiousFire;
+            
+            if (not inputBlocked  and  continiousFireOn  and  not holdFire){ 
+                
+                // create a new continious bullet obj for each reference tick that has passed
+                for (fireCredit += tickScale; fireCredit >= 1.0F; fireCredit -= 1.0F){
+                    spawnBullet((fireType == 1)? BLUE_BULLET_ANIM : RED_BULLET_ANIM, ships.x[ship], ships.y[ship], ships.angle[ship], 11);
+                }
+                events.continiousFired = true;
+                // continue the continious fire upto 3 seonds then block it for recharge
+                if (tickNo - fireStartTick >= ticksOf(3)){ 
+                    holdFire = true;  fireHoldTick = tickNo; 
+                    timers.schedule(FIRE_RECHARGE_TIMER, fireHoldTick + ticksOf(10), fireHoldTick);
+                }
+            }
+            
+            
+            /////////////////////////// @c SHIP-MOVEMENT-LOGIC //////////////////////////
+            
+            
+            if (not inputBlocked  and  input.rotateRight){ ships.angle[ship] += 2.9F * tickScale; }
+            if (not inputBlocked  and  input.rotateLeft){  ships.angle[ship] -= 2.9F * tickScale; }
+            // cahnging the space ship image based on enable/disable boost of the space ship
+            spaceshipBoost = not inputBlocked  and  input.thrust;
+            ships.clip[ship] = spaceshipBoost? SPACESHIP_BOOST_ANIM : SPACESHIP_ANIM;
+            
+            
+            ///////////////////////// @c COLLISION-DETECTION-LOGIC-AND-INPUT-HOLD ////////////////////////
+            
+            
+            ASTEROID_PROFILE_MARK(COLLISION_PHASE);
+            // insert the asteroids into the broadphase grid, so the bullets and the spaceship are
+            // only tested against the asteroids around them instead of against every object
+            broadphase.rebuild(rocks, worldW, worldH, hulls);
+            candidatePairs = 0;
+            
+            // the bullets are tested along the whole path of their last step, not only at its end, otherwise a fast 
+            // bullet (or a low simulation rate) jumps over a small asteroid; the velocities are stored after the 
+            // step, so the step of an entity is its (dx, dy) * tickScale (a bullet moved with its mean velocity, half
+            // an acceleration less, the tested path starts that fraction of a pixel behind it)
+            // an asteroid inside the reach of a path can move by its own step too, so the query reaches that much further
+            const float reach = broadphase.getCellSize() + ASTEROID_MAX_SPEED * std::sqrt(2.0F) * tickScale;
+            
+            // the workers only read the pools and write the hits of their bullets into their own buffers
+            for (auto &worker : workerHits){ worker.hits.clear();  worker.candidatePairs = 0; }
+            // the asteroids of a cell are tested (NARROWPHASE_BATCH) at a time into a hit mask
+            const PackedCircles packedRocks = broadphase.getPacked();
+            jobs.parallelFor(bullets.size(), UPDATE_GRAIN, [&](std::size_t begin, std::size_t end, unsigned int w){
+                WorkerHits &worker = workerHits[w];
+                for (std::size_t b = begin; b < end; ++b){
+                    std::uint32_t order = 0;
+                    float x = bullets.x[b], y = bullets.y[b], stepX = bullets.dx[b] * tickScale, stepY = bullets.dy[b] * tickScale;
+                    broadphase.querySegment(x - stepX, y - stepY, x, y, reach, [&](int first, int last){
+                        for (int e = first; e < last; e += NARROWPHASE_BATCH){
+                            std::size_t count = std::min<std::size_t>(last - e, NARROWPHASE_BATCH);
+                            worker.candidatePairs += count;
+                            std::uint32_t hits = sweptHitMask(x, y, stepX, stepY, bullets.R[b], packedRocks, e, count, tickScale);
+                            for (int k = 0; hits != 0; ++k, hits >>= 1){
+                                if (not (hits & 1)){ continue; }
+                                // the circles touch, the hull of the asteroid decides (the path is in the frame of the moving asteroid)
+                                int r = broadphase.entryAt(e + k);
+                                float rockStepX = rocks.dx[r] * tickScale, rockStepY = rocks.dy[r] * tickScale;
+                                if (hulls != nullptr  and  not hulls->hits(rocks.clip[r], rocks.playhead[r], rocks.x[r], rocks.y[r], rocks.angle[r], 
+                                                                           x - stepX + rockStepX, y - stepY + rockStepY, x, y, bullets.R[b])){ continue; }
+                                worker.hits.push_back(BulletHit{ static_cast<std::uint32_t>(b), order++, static_cast<std::uint32_t>(r) });
+                            }
+                        }
+                    });
+                }
+            });
+            // merge the hits in bullet order (the order the single threaded game found them in)
+            bulletHits.clear();
+            for (auto &worker : workerHits){ 
+                bulletHits.insert(bulletHits.end(), worker.hits.begin(), worker.hits.end());
+                candidatePairs += worker.candidatePairs;
+            }
+            std::sort(bulletHits.begin(), bulletHits.end(), [](const BulletHit &h1, const BulletHit &h2){
+                return (h1.bullet != h2.bullet)? h1.bullet < h2.bullet : h1.order < h2.order;
+            });
+            for (const auto &hit : bulletHits){
+                std::uint32_t b = hit.bullet, r = hit.rock;
+                // an asteroid which is already broken by another bullet in this tick is skipped
+                if (rocks.split[r]){ continue; }
+                
+                bullets.life[b] = rocks.life[r] = false; 
+                // if R = 10, means it is already a small asteroid, so not break it furthur
+                if (rocks.R[r] != 10){ // this refer to big asteroids
+                    rocks.split[r] = true; 
+                    ++playerScore; // increment the if only a big asteroid destroyed
+                }
+                // create a explosion effect based on the asteroid type
+                particles.burst((rocks.R[r] == 10)? SMALL_ROCK_BURST : BIG_ROCK_BURST, rocks.x[r], rocks.y[r]);
+            }
+            // the hunters are few, the bullets are tested against them one at a time (after the asteroids took their hits)
+            if (hunters.size() > 0){
+                hunterBroadphase.rebuild(hunters, worldW, worldH);
+                const float hunterReach = hunterBroadphase.getCellSize() + HUNTER_SPEED * std::sqrt(2.0F) * tickScale;
+                for (std::size_t b = 0; b < bullets.size(); ++b){
+                    float x = bullets.x[b], y = bullets.y[b], stepX = bullets.dx[b] * tickScale, stepY = bullets.dy[b] * tickScale;
+                    hunterBroadphase.querySegment(x - stepX, y - stepY, x, y, hunterReach, [&](int first, int last){
+                        for (int e = first; e < last  and  bullets.life[b]; ++e){
+                            int h = hunterBroadphase.entryAt(e);
+                            ++candidatePairs;
+                            if (not hunters.life[h]  or  not isSweptCollided(x, y, stepX, stepY, bullets.R[b], hunters.x[h], hunters.y[h], 
+                                                                             hunters.dx[h] * tickScale, hunters.dy[h] * tickScale, hunters.R[h])){ continue; }
+                            bullets.life[b] = hunters.life[h] = false;
+                            ++playerScore;
+                            particles.burst(SMALL_ROCK_BURST, hunters.x[h], hunters.y[h]);
+                        }
+                    });
+                }
+            }
+            // upon collision between player and asteroid or hunter
+            auto hitShip = [&](){
+                --playerHealthCount; 
+                // create a different explosion effect for the spaceship colliding
+                EntityHandle explosion = gameObjs.spawn(EXPLOSION, SHIP_EXPLOSION_ANIM, ships.x[ship], ships.y[ship]);
+                timers.schedule(EXPLOSION_END_TIMER, tickNo + explosionTicks, tickNo, explosion);
+                events.shipHit = true;
+                
+                // block the ship movements after the collsion for some times by holding keyboard inputs
+                inputBlocked = true;  inputBlockedTick = tickNo;
+                timers.schedule(INPUT_UNBLOCK_TIMER, inputBlockedTick + ticksOf(0.5F), inputBlockedTick);
+                ships.dx[ship] = ships.dy[ship] = 0;
+                
+                if (playerHealthCount <= 0){ events.gameOver = true; }
+            };
+            broadphase.query(ships.x[ship], ships.y[ship], [&](int r){
+                if (rocks.split[r]){ return; }
+                ++candidatePairs;
+                
+                float shipX = ships.x[ship], shipY = ships.y[ship];
+                float rockR = (hulls != nullptr)? hulls->radiusOf(rocks.clip[r], rocks.R[r]) : rocks.R[r];
+                if ( isCollided(shipX, shipY, ships.R[ship], rocks.x[r], rocks.y[r], rockR)  and  (hulls == nullptr  
+                     or  hulls->hits(rocks.clip[r], rocks.playhead[r], rocks.x[r], rocks.y[r], rocks.angle[r], shipX, shipY, shipX, shipY, ships.R[ship])) ){
+                    rocks.life[r] = false;   hitShip();
+                }
+            });
+            for (std::size_t h = 0; h < hunters.size(); ++h){
+                if (hunters.life[h]  and  isCollided(ships.x[ship], ships.y[ship], ships.R[ship], hunters.x[h], hunters.y[h], hunters.R[h])){
+                    hunters.life[h] = false;   hitShip();
+                }
+            }
+            
+            
+            ////// @c REMOVE-THE-EXPLOSION-OBJ'S-AFTER-ANIMATION,-AND-SPAWN-NEW-SMALL-ASTEROIDS ///////
+            
+            
+            ASTEROID_PROFILE_MARK(CLEANUP_PHASE);
+            // the explosions end by their timers
+            // only the asteroids existing before this loop can be split (new ones are appended)
+            for (std::size_t i = 0, count = rocks.size(); i < count; ++i){
+                if (rocks.split[i]){
+                    for (short int k = 0; k < 4; ++k){
+                        spawnAsteroid(gameObjs, SMALL_ASTEROID_ANIM, rocks.x[i], rocks.y[i], randNo(randGen)%360, 10);
+                    }
+                }
+            }
+            
+            ///////////////////////// @c ALL-OBJECTS-UPDATE-LOGIC-FOR-EACH-TICK ////////////////////////
+            
+            
+            ASTEROID_PROFILE_MARK(UPDATE_PHASE);
+            // update the game objects pool by pool (the big pools in parallel batches) and remove the ones not needed
+            updateSpaceShips(ships);   updateAnimations(ships, clips, 0, ships.size());
+            jobs.parallelFor(bullets.size(), UPDATE_GRAIN, [&](std::size_t begin, std::size_t end, unsigned int){
+                updateBullets(bullets, begin, end, tickNo);    updateAnimations(bullets, clips, begin, end);
+                chunks.killAsleep(bullets, begin, end);        // a bullet leaving the awake chunks is gone like one leaving the screen
+            });
+            jobs.parallelFor(rocks.size(), UPDATE_GRAIN, [&](std::size_t begin, std::size_t end, unsigned int){
+                updateAsteroids(rocks, begin, end);            updateAnimations(rocks, clips, begin, end);
+            });
+            jobs.parallelFor(explosions.size(), UPDATE_GRAIN, [&](std::size_t begin, std::size_t end, unsigned int){
+                updateAnimations(explosions, clips, begin, end);
+            });
+            // every FLOW_REFRESH the hunters take the field the worker built since the last refresh, and it starts on the next
+            if (hunters.size() > 0  and  tickNo % std::max<std::uint64_t>(1, ticksOf(FLOW_REFRESH)) == 0){ 
+                flow.refresh(rocks, ships.x[ship], ships.y[ship]); 
+            }
+            jobs.parallelFor(hunters.size(), UPDATE_GRAIN, [&](std::size_t begin, std::size_t end, unsigned int){
+                updateHunters(hunters, flow, ships.x[ship], ships.y[ship], begin, end);
+            });
+            particles.emit(particleBudget);
+            jobs.parallelFor(particles.size(), UPDATE_GRAIN, [&](std::size_t begin, std::size_t end, unsigned int){
+                particles.update(begin, end);
+            });
+            particles.removeDead();
+            // the chunks around the ship wake up, the asteroids which drifted away fall asleep
+            chunks.follow(ships.x[ship], ships.y[ship], gameObjs, tickNo);
+            
+            gameObjs.removeDead(BULLET);
+            gameObjs.removeDead(ASTEROID);
+            gameObjs.removeDead(EXPLOSION);
+            gameObjs.removeDead(HUNTER);
+            
+            //////////////////////////// @c CREATE-A-NEW-WAVE /////////////////////////
+            
+            
+            ASTEROID_PROFILE_MARK(WAVE_PHASE);
+            // the scenario events whose time has come
+            while (scenario != nullptr  and  nextScenarioEvent < scenario->getEvents().size()  
+                   and  tickNo >= ticksOf(scenario->getEvents()[nextScenarioEvent].seconds)){
+                playScenarioEvent(scenario->getEvents()[nextScenarioEvent++]);
+            }
+            // the next wave comes (WAVE_DELAY) after the field is cleared, the first one at once
+            if (wavesOn  and  not wavePending  and  gameObjs.count() + chunks.getSleeperCount() == 1){ // when only one obj is left which is spaceship
+                timers.schedule(NEXT_WAVE_TIMER, tickNo + ticksOf((waveNo == 0)? 0.0F : WAVE_DELAY), tickNo);
+                wavePending = true;
+            }
+            ASTEROID_PROFILE_END_MARK();
+#ifdef ASTEROID_COUNT_ALLOCATIONS
+            tickAllocations = heapAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+#endif
+        }
+    };
+    
+    
+    ////////////////////////////////// @c INPUT-RECORDING //////////////////////////////////
+    
+    
+    // everything besides the inputs which decides how a recorded game plays
+    struct RecordingHeader { 
+        std::uint32_t seed;  float simulationRate, worldW, worldH;  std::int16_t fireType;  std::uint32_t huntersPerWave, hullFrames; 
+    };
+    const char RECORDING_MAGIC[4] = { 'A', 'S', 'T', 'R' };
+    const std::uint8_t RECORDING_VERSION = 3; // 2 : the hunters per wave, 3 : the asteroid hit shapes
+    
+    // the asteroid frames with a baked hull, 0 when the asteroids are circles; a game only plays the same with the same hit shapes
+    inline std::uint32_t hullFramesOf(const RockHulls *hulls){ return (hulls != nullptr)? static_cast<std::uint32_t>(hulls->getFrameCount()) : 0; }
+    inline std::string describeHulls(std::uint32_t hullFrames){ 
+        return (hullFrames > 0)? std::to_string(hullFrames) + " asteroid frame hulls" : std::string("circle asteroids"); 
+    }
+    
+    // the inputs of a tick packed into the bits of one byte
+    inline std::uint8_t packInput(const TickInput &input){
+        return input.rotateLeft | input.rotateRight << 1 | input.thrust << 2 
+             | input.fireSingle << 3 | input.changeFireType << 4 | input.continiousFire << 5;
+    }
+    inline void unpackInput(std::uint8_t bits, TickInput &input){
+        input.rotateLeft     = bits & 1;          input.rotateRight    = bits & 2;
+        input.thrust         = bits & 4;          input.fireSingle     = bits & 8;
+        input.changeFireType = bits & 16;         input.continiousFire = bits & 32;
+    }
+    
+    class InputRecorder { // writes the input of every tick to a file, equal inputs in a row are stored once
+        
+        private : 
+        
+        std::ofstream file;
+        std::uint8_t runInput;
+        std::uint64_t runLength;
+        /*
+        file format (little endian) : the magic "ASTR", the version byte, the RecordingHeader fields, then
+        one run per input change : the packed input byte and the number of ticks it lasted (a varint)
+        */
+        void writeRun(){
+            if (runLength == 0){ return; }
+            file.put(static_cast<char>(runInput));
+            // varint : 7 bits per byte, the high bit tells that more bytes follow
+            for (std::uint64_t n = runLength; ; n >>= 7){
+                if (n < 0x80){ file.put(static_cast<char>(n));  break; }
+                file.put(static_cast<char>((n & 0x7F) | 0x80));
+            }
+            runLength = 0;
+        }
+        template <typename T> void writeField(const T &field){ file.write(reinterpret_cast<const char *>(&field), sizeof(T)); }
+        
+        public : 
+        
+        InputRecorder(const std::string &fileName, const RecordingHeader &header) 
+            : file(fileName, std::ios::binary) {
+            runInput = 0;  runLength = 0;
+            file.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+            file.put(static_cast<char>(RECORDING_VERSION));
+            writeField(header.seed);   writeField(header.simulationRate);
+            writeField(header.worldW); writeField(header.worldH);   writeField(header.fireType);
+            writeField(header.huntersPerWave);   writeField(header.hullFrames);
+        }
+        ~InputRecorder() noexcept { writeRun(); } // also runs when the game over is thrown
+        
+        inline bool isOpen() const { return file.is_open(); }
+        
+        void record(const TickInput &input){
+            std::uint8_t bits = packInput(input);
+            if (runLength > 0  and  bits != runInput){ writeRun(); }
+            runInput = bits;  ++runLength;
+        }
+    };
+    
+    class InputReplay { // feeds the ticks of a recording back in the recorded order
+        
+        private : 
+        
+        std::vector<std::uint8_t> runInputs;
+        std::vector<std::uint64_t> runLengths;
+        std::size_t run;
+        std::uint64_t tickInRun;
+        RecordingHeader header;
+        
+        public : 
+        
+        InputReplay() noexcept { run = 0;  tickInRun = 0;  header = RecordingHeader{ 0, 120.0F, 1280.0F, 800.0F, 1, 0, 0 }; }
+        ~InputReplay() noexcept {}
+        
+        // reads the whole recording, returns false if it is missing or not a recording of this version
+        bool load(const std::string &fileName){
+            std::ifstream file(fileName, std::ios::binary);
+            char magic[4] = {};
+            file.read(magic, sizeof(magic));
+            if (not file  or  not std::equal(magic, magic + 4, RECORDING_MAGIC)  or  file.get() != RECORDING_VERSION){ 
+                return false; 
+            }
+            auto readField = [&](auto &field){ file.read(reinterpret_cast<char *>(&field), sizeof(field)); };
+            readField(header.seed);   readField(header.simulationRate);
+            readField(header.worldW); readField(header.worldH);   readField(header.fireType);
+            readField(header.huntersPerWave);   readField(header.hullFrames);
+            // a broken header would make the tick length infinite or not a number, the sizes and the rate have to be
+            // positive like the command line options
+            auto positive = [](float value){ return std::isfinite(value)  and  value > 0.0F; };
+            if (not file  or  not positive(header.simulationRate)  or  not positive(header.worldW)  or  not positive(header.worldH)
+                or  header.fireType < 1  or  header.fireType > 3){
+                header = RecordingHeader{ 0, 120.0F, 1280.0F, 800.0F, 1, 0, 0 };
+                return false;
+            }
+            
+            for (int input; (input = file.get()) != EOF; ){
+                std::uint64_t length = 0;
+                for (int shift = 0, byte; (byte = file.get()) != EOF; shift += 7){
+                    length |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0){ break; }
+                }
+                runInputs.push_back(static_cast<std::uint8_t>(input));  runLengths.push_back(length);
+            }
+            run = 0;  tickInRun = 0;
+            return static_cast<bool>(file.eof()  and  not file.bad());
+        }
+        inline const RecordingHeader& getHeader() const { return header; }
+        inline bool isOver() const { return run >= runInputs.size(); }
+        
+        // the input of the next tick, returns false when the recording is over
+        bool next(TickInput &input){
+            if (isOver()){ return false; }
+            unpackInput(runInputs[run], input);
+            if (++tickInRun >= runLengths[run]){ ++run;  tickInRun = 0; }
+            return true;
+        }
+    };
+    
+    // applies a recorded header so the simulation starts exactly like the recorded one, returns false (and applies
+    // nothing) when the recording was made with other asteroid hit shapes (hulls) than this game has
+    bool applyRecordingHeader(const RecordingHeader &header, const RockHulls *hulls){
+        if (header.hullFrames != hullFramesOf(hulls)){
+            std::cerr << "the recording was made with " << describeHulls(header.hullFrames) << ", this game has " 
+                      << describeHulls(hullFramesOf(hulls)) << " (bake or remove Images/Asteroid/hulls.txt to match)\n";
+            return false;
+        }
+        randGen.seed(header.seed);                  randomSeed = header.seed;
+        simulationRate = header.simulationRate;     tickScale = REFERENCE_RATE / simulationRate;
+        worldW = header.worldW;                     worldH = header.worldH;
+        fireType = header.fireType;                 huntersPerWave = header.huntersPerWave;
+        return true;
+    }
+    inline RecordingHeader currentRecordingHeader(const RockHulls *hulls){ 
+        return RecordingHeader{ randomSeed, simulationRate, worldW, worldH, fireType, huntersPerWave, hullFramesOf(hulls) }; 
+    }
+    
+    
+    ////////////////////////////////// @c SAVE-AND-RESUME //////////////////////////////////
+    
+    
+    // everything besides the World which decides how a saved session goes on
+    struct SessionHeader { 
+        float simulationRate, worldW, worldH;  std::int16_t fireType, waveStep;  std::uint32_t seed, scenarioEvents, huntersPerWave, hullFrames; 
+    };
+    inline SessionHeader currentSessionHeader(const World &world){
+        std::size_t scenarioEvents = (world.scenario != nullptr)? world.scenario->getEvents().size() : 0;
+        return SessionHeader{ simulationRate, worldW, worldH, fireType, waveStep, randomSeed, static_cast<std::uint32_t>(scenarioEvents), 
+                              huntersPerWave, hullFramesOf(world.hulls) };
+    }
+    
+    // writes the session to (fileName) (see SAVE_MAGIC for the layout), returns the bytes written or 0 when
+    // the file can not be written
+    std::size_t saveSession(const World &world, const std::string &fileName){
+        SaveWriter out;
+        out.array(SAVE_MAGIC, sizeof(SAVE_MAGIC));   out.field(SAVE_VERSION);
+        SessionHeader header = currentSessionHeader(world);
+        out.field(header.simulationRate);   out.field(header.worldW);     out.field(header.worldH);
+        out.field(header.fireType);         out.field(header.waveStep);   out.field(header.seed);   out.field(header.scenarioEvents);
+        out.field(header.huntersPerWave);   out.field(header.hullFrames);
+        // the standard gives the generator state only as text, it is saved as one block of it
+        std::ostringstream generator;
+        generator << randGen;
+        std::string state = generator.str();
+        out.field(static_cast<std::uint64_t>(state.size()));   out.array(state.data(), state.size());
+        world.save(out);
+        
+        std::ofstream file(fileName, std::ios::binary);
+        file.write(out.getBytes().data(), out.getBytes().size());
+        return file? out.getBytes().size() : 0;
+    }
+    
+    // continues the session saved in (fileName), the world has to be made with the same scenario and run at the 
+    // same simulation rate in the same world size; returns false when there is no save, or it does not fit 
+    // (the world is a new game then)
+    bool loadSession(World &world, const std::string &fileName){
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (not file){ return false; }
+        std::vector<char> bytes(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(bytes.data(), bytes.size());
+        
+        SaveReader in(bytes.data(), bytes.size());
+        char magic[4] = {};
+        std::uint8_t version = 0;
+        in.array(magic, sizeof(magic));   in.field(version);
+        if (not file  or  not in.isValid()  or  not std::equal(magic, magic + 4, SAVE_MAGIC)  or  version != SAVE_VERSION){ 
+            std::cerr << fileName << " is not a saved session of this version\n";  return false; 
+        }
+        SessionHeader header{}, current = currentSessionHeader(world);
+        in.field(header.simulationRate);    in.field(header.worldW);      in.field(header.worldH);
+        in.field(header.fireType);          in.field(header.waveStep);    in.field(header.seed);    in.field(header.scenarioEvents);
+        in.field(header.huntersPerWave);    in.field(header.hullFrames);
+        if (header.simulationRate != current.simulationRate  or  header.worldW != current.worldW  or  header.worldH != current.worldH){
+            std::cerr << fileName << " was saved at " << header.simulationRate << " Hz in a " << header.worldW << " x " 
+                      << header.worldH << " world, it can only be resumed with the same --sim-rate and screen\n";
+            return false;
+        }
+        if (header.scenarioEvents != current.scenarioEvents){ std::cerr << fileName << " was saved with another scenario\n";  return false; }
+        if (header.hullFrames != current.hullFrames){
+            std::cerr << fileName << " was saved with " << describeHulls(header.hullFrames) << ", this game has " 
+                      << describeHulls(current.hullFrames) << " (bake or remove Images/Asteroid/hulls.txt to match)\n";
+            return false;
+        }
+        
+        std::string state(in.count(1), ' ');
+        in.array(&state[0], state.size());
+        std::istringstream generator(state);
+        std::mt19937 restored;
+        if (not (generator >> restored)  or  not world.load(in)){ std::cerr << fileName << " is broken\n";  return false; }
+        randGen = restored;   randomSeed = header.seed;
+        fireType = header.fireType;   waveStep = header.waveStep;
+        huntersPerWave = header.huntersPerWave;   world.reserveHunters(); // the saved hunters, not the ones of the command line
+        return true;
+    }
+    
+    
+#ifdef ASTEROID_HEADLESS
+    
+    ////////////////////////////////// @c HEADLESS-BENCHMARK //////////////////////////////////
+    
+    
+    // a fixed input script : the ship keeps turning, thrusts in short bursts, taps single fire,
+    // holds the special fire (released once per recharge cycle) and changes the fire type now and then
+    void scriptedInput(std::uint64_t tickNo, TickInput &input){
+        input.rotateRight    = true;
+        input.thrust         = tickNo % ticksOf(2)  <  ticksOf(0.25F);
+        input.fireSingle     = tickNo % ticksOf(0.1F) == 0;
+        input.changeFireType = tickNo % ticksOf(5) == 0;
+        input.continiousFire = tickNo % ticksOf(13.5F) != 0;
+    }
+    // random inputs : each key is pressed or released at random moments
+    void randomInput(std::mt19937 &inputGen, TickInput &input){
+        std::uniform_int_distribution<> chance(0, 99);
+        if (chance(inputGen) < 5){ input.rotateLeft  = not input.rotateLeft; }
+        if (chance(inputGen) < 5){ input.rotateRight = not input.rotateRight; }
+        if (chance(inputGen) < 3){ input.thrust      = not input.thrust; }
+        if (chance(inputGen) < 2){ input.continiousFire = not input.continiousFire; }
+        input.fireSingle     = chance(inputGen) < 10;
+        input.changeFireType = chance(inputGen) < 1;
+    }
+    
+    struct BenchmarkResult {
+        std::uint64_t ticks = 0, objectUpdates = 0, peakObjects = 0, firstTickAllocations = 0, laterAllocations = 0;
+        std::uint64_t spawnsDropped = 0, peakParticles = 0, particlesCut = 0, peakTimers = 0;
+        std::uint64_t startTick = 0, saveBytes = 0, sleepingRocks = 0;
+        std::uint64_t flowBuilds = 0, flowReused = 0, flowLate = 0;
+        short int wavesCleared = 0, score = 0, shipDeaths = 0;
+        double seconds = 0, loadSeconds = 0, saveSeconds = 0; // of the --resume and the --save-at checkpoint
+        std::uint64_t checksum = 0; // of the final game state, equal checksums mean the same game was played
+    };
+    
+    // runs the game simulation with no window, sounds or images until (benchmarkWaves) waves are cleared
+    // on (threads) worker threads, the ship gets its health back whenever it is destroyed
+    BenchmarkResult runBenchmark(const AnimationClip *clips, unsigned int threads, const Scenario *scenario, const RockHulls *hulls){
+        
+        std::mt19937 inputGen(1234);  // the same random inputs on every run
+        fireType = 1;
+        randGen.seed(seedGiven? randomSeed : 2024); // the same asteroids on every run
+        if (not seedGiven){ randomSeed = 2024; }
+        
+        InputReplay replay;
+        if (not replayFile.empty()){
+            if (not replay.load(replayFile)){ std::cerr << "can not replay " << replayFile << "\n";  return BenchmarkResult(); }
+            if (not applyRecordingHeader(replay.getHeader(), hulls)){ return BenchmarkResult(); }
+        }
+        std::unique_ptr<InputRecorder> recorder;
+        if (not recordFile.empty()){ recorder.reset(new InputRecorder(recordFile, currentRecordingHeader(hulls))); }
+        
+        World world(clips, threads, scenario, hulls);
+        TickInput input;
+        BenchmarkResult result;
+        
+        // a checkpoint goes on from its tick, with the scripted inputs it ends with the checksum of the whole run
+        if (not resumeFile.empty()){
+            auto loadStart = std::chrono::steady_clock::now();
+            if (not loadSession(world, resumeFile)){ std::cerr << "can not resume " << resumeFile << "\n";  return BenchmarkResult(); }
+            result.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+            result.startTick = world.tickNo;
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        // a replay runs until the recording is over
+        while ((replayFile.empty()? world.waveNo <= benchmarkWaves : not replay.isOver())  and  world.tickNo < benchmarkMaxTicks){
+            
+            if (not replayFile.empty()){ replay.next(input); }
+            else if (randomInputs){ randomInput(inputGen, input); }
+            else { scriptedInput(world.tickNo, input); }
+            if (recorder){ recorder->record(input); }
+            
+            TickEvents events;
+            world.tick(input, events);
+            ASTEROID_PROFILE_FRAME(world.gameObjs); // each tick is a frame of the headless run
+            if (events.gameOver){ world.playerHealthCount = 5;  ++result.shipDeaths; }
+            if (world.tickNo == result.startTick + 1){ result.firstTickAllocations = world.tickAllocations; }
+            else { result.laterAllocations += world.tickAllocations; }
+            if (world.tickNo == saveAtTick){
+                auto saveStart = std::chrono::steady_clock::now();
+                result.saveBytes = saveSession(world, saveFile);
+                result.saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - saveStart).count();
+                if (result.saveBytes == 0){ std::cerr << "can not write " << saveFile << "\n"; }
+            }
+            
+            std::uint64_t objects = world.gameObjs.count();
+            result.objectUpdates += objects;
+            result.peakObjects = std::max(result.peakObjects, objects);
+            result.peakParticles = std::max<std::uint64_t>(result.peakParticles, world.particles.size());
+            result.peakTimers = std::max<std::uint64_t>(result.peakTimers, world.timers.size());
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.ticks = world.tickNo - result.startTick;   result.wavesCleared = std::max(0, world.waveNo - 1);
+        result.score = world.playerScore;            result.spawnsDropped = world.gameObjs.getSpawnsDropped();
+        result.checksum = world.checksum();            result.particlesCut = world.particles.getCutCount();
+        result.sleepingRocks = world.chunks.getSleeperCount();
+        result.flowBuilds = world.flow.getBuildCount();   result.flowReused = world.flow.getReusedCount();   result.flowLate = world.flow.getLateCount();
+        return result;
+    }
+    
+    // times the narrowphase alone : every bullet against (benchmarkNarrowphase) packed asteroids, one pair at a time
+    // through (isCollided) and (isSweptCollided) like the game did before, and a batch at a time through (sweptHitMask)
+    void NarrowphaseBenchmark(){
+        
+        const std::size_t rockCount = benchmarkNarrowphase, bulletCount = 256;
+        std::mt19937 generator(seedGiven? randomSeed : 2024); // the same pairs on every run
+        std::uniform_real_distribution<float> position(0.0F, 200.0F), speed(0.0F, ASTEROID_MAX_SPEED), bulletStep(-30.0F, 30.0F);
+        
+        std::vector<float> x(rockCount), y(rockCount), dx(rockCount), dy(rockCount), R(rockCount);
+        std::vector<int> order(rockCount); // the game reached the pool through the broadphase entries
+        for (std::size_t r = 0; r < rockCount; ++r){
+            x[r] = position(generator);   y[r] = position(generator);   dx[r] = speed(generator);   dy[r] = speed(generator);
+            R[r] = (generator() & 1)? 20.0F : 10.0F;   order[r] = static_cast<int>(r);
+        }
+        std::shuffle(order.begin(), order.end(), generator);
+        std::vector<float> bx(bulletCount), by(bulletCount), bStepX(bulletCount), bStepY(bulletCount);
+        for (std::size_t b = 0; b < bulletCount; ++b){ 
+            bx[b] = position(generator);   by[b] = position(generator);   bStepX[b] = bulletStep(generator);   bStepY[b] = bulletStep(generator); 
+        }
+        const PackedCircles packed{ x.data(), y.data(), dx.data(), dy.data(), R.data() };
+        
+        // repeats a pass over all the pairs until it took a quarter second, returns the ns per pair and the hits of a pass
+        auto measure = [&](auto &&pass, std::size_t &hits){
+            std::size_t rounds = 0;
+            auto start = std::chrono::steady_clock::now();
+            double seconds = 0;
+            do { hits = pass();  ++rounds;  seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+            while (seconds < 0.25);
+            return seconds * 1e9 / (static_cast<double>(rounds) * rockCount * bulletCount);
+        };
+        std::size_t pointHits, sweptHits, maskHits;
+        double pointTime = measure([&](){
+            std::size_t hits = 0;
+            for (std::size_t b = 0; b < bulletCount; ++b){
+                for (int r : order){ hits += isCollided(bx[b], by[b], 10.0F, x[r], y[r], R[r]); }
+            }
+            return hits;
+        }, pointHits);
+        double sweptTime = measure([&](){
+            std::size_t hits = 0;
+            for (std::size_t b = 0; b < bulletCount; ++b){
+                for (int r : order){ hits += isSweptCollided(bx[b], by[b], bStepX[b], bStepY[b], 10.0F, x[r], y[r], dx[r], dy[r], R[r]); }
+            }
+            return hits;
+        }, sweptHits);
+        double maskTime = measure([&](){
+            std::size_t hits = 0;
+            for (std::size_t b = 0; b < bulletCount; ++b){
+                for (std::size_t first = 0; first < rockCount; first += NARROWPHASE_BATCH){
+                    std::size_t count = std::min(rockCount - first, NARROWPHASE_BATCH);
+                    std::uint32_t mask = sweptHitMask(bx[b], by[b], bStepX[b], bStepY[b], 10.0F, packed, first, count, 1.0F);
+                    for (; mask != 0; mask &= mask - 1){ ++hits; }
+                }
+            }
+            return hits;
+        }, maskHits);
+        
+        std::cout << "Asteroid narrowphase (" << bulletCount << " bullets x " << rockCount << " asteroids, "
+#ifdef ASTEROID_SIMD
+                  << LANES << " lanes)\n"
+#else
+                  << "scalar build)\n"
+#endif
+                  << "  isCollided      : " << pointTime << " ns/pair  (" << pointHits << " hits, the end points only)\n"
+                  << "  isSweptCollided : " << sweptTime << " ns/pair  (" << sweptHits << " hits)\n"
+                  << "  sweptHitMask    : " << maskTime << " ns/pair  (" << maskHits << " hits, " 
+                                            << sweptTime / maskTime << "x faster than isSweptCollided)\n";
+        if (maskHits != sweptHits){ std::cout << "  the hit masks do not match (isSweptCollided)\n"; }
+        
+        // with baked hulls the game tests two levels : the circles around the hulls, then the hull of each pair whose circles touch
+        RockHulls hulls;
+        if (not hulls.load("Images/Asteroid/hulls.txt")){ return; }
+        std::vector<float> boundR(rockCount);
+        std::vector<std::uint8_t> clip(rockCount);
+        for (std::size_t r = 0; r < rockCount; ++r){ 
+            clip[r] = (R[r] == 20.0F)? BIG_ASTEROID_ANIM : SMALL_ASTEROID_ANIM;   boundR[r] = hulls.radiusOf(clip[r], R[r]); 
+        }
+        const PackedCircles bounds{ x.data(), y.data(), dx.data(), dy.data(), boundR.data() };
+        std::size_t circleHits = 0, hullHits;
+        double hullTime = measure([&](){
+            std::size_t hits = 0;
+            circleHits = 0;
+            for (std::size_t b = 0; b < bulletCount; ++b){
+                for (std::size_t first = 0; first < rockCount; first += NARROWPHASE_BATCH){
+                    std::size_t count = std::min(rockCount - first, NARROWPHASE_BATCH);
+                    std::uint32_t mask = sweptHitMask(bx[b], by[b], bStepX[b], bStepY[b], 10.0F, bounds, first, count, 1.0F);
+                    for (std::size_t r = first; mask != 0; ++r, mask >>= 1){
+                        if (not (mask & 1)){ continue; }
+                        ++circleHits;
+                        hits += hulls.hits(clip[r], 0.0F, x[r], y[r], 0.0F, bx[b] - bStepX[b] + dx[r], by[b] - bStepY[b] + dy[r], bx[b], by[b], 10.0F);
+                    }
+                }
+            }
+            return hits;
+        }, hullHits);
+        std::cout << "  two level hulls : " << hullTime << " ns/pair  (" << circleHits << " hits of the circles around the hulls, " 
+                                            << hullHits << " on the hulls)\n";
+    }
+    
+    // prints the cost of the simulation, or with (benchmarkScaling) the time per tick from 1 thread up to
+    // (benchmarkScaling) threads, every thread count must play exactly the same game
+    void Benchmark(){
+        
+        if (benchmarkNarrowphase > 0){ NarrowphaseBenchmark();  return; }
+        
+        sf::Texture noTextures[ANIMATION_COUNT]; // nothing is drawn, the clips only need the frame layout
+        AnimationClip clips[ANIMATION_COUNT];
+        createAnimationClips(noTextures, clips);
+        
+        Scenario stressScenario;
+        if (not scenarioFile.empty()  and  not stressScenario.load(scenarioFile)){ return; }
+        const Scenario *scenario = scenarioFile.empty()? nullptr : &stressScenario;
+        RockHulls rockHulls;       // the asteroids are circles when the hulls are not baked
+        const RockHulls *hulls = rockHulls.load("Images/Asteroid/hulls.txt")? &rockHulls : nullptr;
+        
+        if (benchmarkScaling > 0){
+            std::cout << "Asteroid thread scaling (" << (randomInputs? "random" : "scripted") << " inputs, wave size " 
+                      << waveStep << ")\n  threads    ns/tick    speedup    ticks    score    peak objects\n";
+            double singleThread = 0;
+            for (unsigned int threads = 1; threads <= benchmarkScaling; ++threads){
+                BenchmarkResult result = runBenchmark(clips, threads, scenario, hulls);
+                double perTick = result.seconds * 1e9 / std::max<std::uint64_t>(result.ticks, 1);
+                if (threads == 1){ singleThread = perTick; }
+                std::cout << "  " << threads << "    " << perTick << "    " << singleThread / perTick << "x    " 
+                          << result.ticks << "    " << result.score << "    " << result.peakObjects << "\n";
+            }
+            return;
+        }
+        
+        BenchmarkResult result = runBenchmark(clips, workerThreads, scenario, hulls);
+        std::cout << "Asteroid headless benchmark (" << (randomInputs? "random" : "scripted") << " inputs, " 
+                                          << workerThreads << " threads)\n"
+                  << "  waves cleared  : " << result.wavesCleared << " / " << benchmarkWaves << "\n"
+                  << "  ticks          : " << result.ticks << "  (" << simulationRate << " Hz, " 
+                                          << result.ticks / simulationRate << " s of game time)\n"
+                  << "  time per tick  : " << result.seconds * 1e9 / std::max<std::uint64_t>(result.ticks, 1) << " ns\n"
+                  << "  objects/second : " << result.objectUpdates / std::max(result.seconds, 1e-9) << "\n"
+                  << "  peak objects   : " << result.peakObjects << "  (" << result.spawnsDropped << " spawns dropped on full pools)\n"
+                  << "  peak particles : " << result.peakParticles << "  (" << result.particlesCut << " cut by the budget of " 
+                                          << particleBudget << " per tick)\n"
+                  << "  peak timers    : " << result.peakTimers << "  (waiting in the timer wheel at once)\n"
+                  << "  heap allocs    : " << result.firstTickAllocations << " in the first tick, " 
+                                          << result.laterAllocations << " in all the other ticks\n"
+                  << "  score          : " << result.score << "  (ship destroyed " << result.shipDeaths << " times)\n"
+                  << "  seed           : " << randomSeed << "  (state checksum " << std::hex << result.checksum << std::dec << ")\n"
+                  << "  hit shapes     : " << (hulls? std::to_string(hulls->getFrameCount()) + " asteroid frame hulls" : std::string("circles")) << "\n";
+        if (worldScreens > 1){
+            std::cout << "  world          : " << worldScreens << " x " << worldScreens << " screens  (" << result.sleepingRocks 
+                                          << " asteroids asleep at the end)\n";
+        }
+        if (result.flowBuilds > 0){
+            std::cout << "  flow field     : " << result.flowBuilds << " builds on the worker thread  (" << result.flowReused 
+                                          << " unchanged, " << result.flowLate << " not ready when the ticks needed them)\n";
+        }
+        if (not resumeFile.empty()){
+            std::cout << "  resumed        : " << resumeFile << " at tick " << result.startTick << "  (loaded in " 
+                                          << result.loadSeconds * 1e3 << " ms)\n";
+        }
+        if (result.saveBytes > 0){
+            std::cout << "  checkpoint     : " << saveFile << " at tick " << saveAtTick << "  (" << result.saveBytes / 1024 
+                                          << " KB saved in " << result.saveSeconds * 1e3 << " ms)\n";
+        }
+    }
+    
+#endif // ASTEROID_HEADLESS
+    
+    
+#ifndef ASTEROID_HEADLESS
+    
+    ////////////////////////////////// @c AUDIO-MIXER //////////////////////////////////
+    
+    
+    enum SoundId : std::uint8_t { 
+        SINGLE_FIRE_SOUND, SPECIAL_FIRE_1_SOUND, SPECIAL_FIRE_2_SOUND, SHIP_BOOST_SOUND, SHIP_EXPLOSION_SOUND, MUSIC_SOUND, SOUND_COUNT 
+    };
+    
+    struct SoundEffect { const char *file;  float pitch, volume;  std::uint8_t priority, maxVoices;  bool loop; };
+    
+    // (priority) decides which voice is stolen when all are busy, (maxVoices) is how many copies of the
+    // effect can overlap, a trigger beyond it is ignored (the continious fire triggers on every tick)
+    // the files have no extension, the first of AUDIO_EXTENSIONS found is played (the music is optional)
+    const SoundEffect SOUND_EFFECTS[SOUND_COUNT] = {
+        { "Sounds/Asteroid/weaponsound3",    2.0F, 10.0F, 1, 4, false },
+        { "Sounds/Asteroid/weaponsound1",    2.0F, 10.0F, 1, 1, false },
+        { "Sounds/Asteroid/weaponsound2",    2.0F, 10.0F, 1, 1, false },
+        { "Sounds/Asteroid/thrustsound",     2.0F, 12.5F, 2, 1, true  },
+        { "Sounds/Asteroid/explosionsound1", 1.0F, 100.0F, 3, 4, false },
+        { "Sounds/Asteroid/music",           1.0F, 30.0F, 0, 1, true  }
+    };
+    // the compressed formats come first, so an Ogg or FLAC file next to a WAV replaces it
+    const char *const AUDIO_EXTENSIONS[] = { ".ogg", ".flac", ".wav" };
+    const float STREAM_SECONDS = 5.0F; // a longer sound is streamed from its file instead of being decoded into memory
+    
+    // the file of a sound with the first extension that exists, empty when there is none
+    std::string findAudioFile(const std::string &name){
+        for (const char *extension : AUDIO_EXTENSIONS){
+            std::string file = name + extension;
+            if (std::ifstream(file).good()){ return file; }
+        }
+        return std::string();
+    }
+    
+    // a single producer single consumer ring buffer, the two threads never wait for each other
+    template <typename T, std::size_t CAPACITY>
+    class SpscQueue {
+        
+        private : 
+        
+        T items[CAPACITY];
+        alignas(64) std::atomic<std::size_t> head; // next item to read, only the consumer moves it
+        alignas(64) std::atomic<std::size_t> tail; // next free place, only the producer moves it
+        
+        public : 
+        
+        SpscQueue() noexcept : head(0), tail(0) {}
+        
+        // returns false when the queue is full
+        bool push(const T &item){
+            std::size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == CAPACITY){ return false; }
+            items[t % CAPACITY] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+        bool pop(T &item){
+            std::size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)){ return false; }
+            item = items[h % CAPACITY];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+        // called by the consumer
+        inline bool isEmpty() const { return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire); }
+    };
+    
+    class AudioMixer { // plays the effects on a fixed pool of voices, owned by its own thread
+        
+        private : 
+        
+        struct SoundCommand { std::uint8_t sound;  bool stop; };
+        struct Voice { sf::Sound sound;  std::uint8_t effect = SOUND_COUNT;  std::uint64_t startedAt = 0; };
+        
+        static constexpr std::size_t VOICE_COUNT = 16;
+        sf::SoundBuffer buffers[SOUND_COUNT];
+        std::unique_ptr<sf::Music> streams[SOUND_COUNT];
+        std::atomic<bool> ready[SOUND_COUNT];
+        bool waiting[SOUND_COUNT];
+        Voice voices[VOICE_COUNT];
+        SpscQueue<SoundCommand, 256> commands;
+        std::atomic<bool> quit, loaded;
+        std::mutex wakeLock;
+        std::condition_variable wake;
+        bool woken;
+        std::atomic<bool> sleeping;
+        std::uint64_t triggers;
+        std::atomic<std::uint64_t> residentBytes, loadMicroseconds;
+        std::atomic<unsigned int> streamedSounds;
+        std::thread loaderThread, mixerThread;
+        /*
+        buffers     : the decoded samples of each short effect, decoded once and shared by all the voices playing it
+        streams     : the long sounds (the music), decoded piece by piece from the file while they play
+        ready       : set by the loader thread when the buffer or the stream of a sound can be played
+        waiting     : a loop triggered before it was ready, it starts when it is (a late one shot is dropped)
+        voices      : the sf::Sound objects, only the mixer thread touches them
+        commands    : the play and stop triggers of the game thread
+        wake        : the mixer thread sleeps on it until a trigger, a loaded sound or the quit sets (woken); the game 
+                      thread only takes (wakeLock) to wake it when it is (sleeping), a trigger never waits for the mixer
+        triggers    : counts the started voices, the smallest (startedAt) is the oldest voice
+        residentBytes, loadMicroseconds : the memory of the decoded buffers and the time the loader took (for the stats)
+        */
+        
+        // decodes the short effects and opens the long sounds as streams, the window opens meanwhile
+        void loaderLoop(){
+            sf::Clock clock;
+            for (short int i = 0; i < SOUND_COUNT  and  not quit.load(std::memory_order_acquire); ++i){
+                std::string file = findAudioFile(SOUND_EFFECTS[i].file);
+                if (file.empty()){ continue; } // a missing sound is never played
+                
+                sf::InputSoundFile header; // reads only the header, to know the length
+                if (header.openFromFile(file)  and  header.getDuration() > sf::seconds(STREAM_SECONDS)){
+                    std::unique_ptr<sf::Music> stream(new sf::Music());
+                    if (not stream->openFromFile(file)){ continue; }
+                    streams[i] = std::move(stream);
+                    ++streamedSounds;
+                }
+                else {
+                    if (not buffers[i].loadFromFile(file)){ continue; }
+                    residentBytes += buffers[i].getSampleCount() * sizeof(sf::Int16);
+                }
+                ready[i].store(true, std::memory_order_release);
+                signal(); // a loop triggered before its sound was ready can start now
+            }
+            loadMicroseconds = clock.getElapsedTime().asMicroseconds();
+            loaded.store(true, std::memory_order_release);
+        }
+        // wakes the mixer thread, the lock is only held by it while it checks (woken), so this never waits for the mixing
+        void signal(){
+            { std::lock_guard<std::mutex> hold(wakeLock);  woken = true; }
+            wake.notify_one();
+        }
+        // the game thread after a push, it only locks when the mixer thread sleeps (the fences pair with the ones
+        // of the mixer, so either the mixer sees the pushed command or this sees it sleeping)
+        inline void wakeIfSleeping(){
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed)){ signal(); }
+        }
+        inline bool isBusy(const Voice &voice) const { return voice.sound.getStatus() == sf::Sound::Playing; }
+        
+        void play(std::uint8_t effect){
+            
+            const SoundEffect &sfx = SOUND_EFFECTS[effect];
+            if (streams[effect]){ // a streamed sound has its own source, it plays once at a time
+                sf::Music &stream = *streams[effect];
+                stream.stop();
+                stream.setPitch(sfx.pitch);    stream.setVolume(sfx.volume);    stream.setLoop(sfx.loop);
+                stream.play();
+                return;
+            }
+            Voice *freeVoice = nullptr, *victim = nullptr;
+            std::uint8_t playing = 0;
+            
+            for (auto &voice : voices){
+                if (not isBusy(voice)){ if (freeVoice == nullptr){ freeVoice = &voice; } continue; }
+                if (voice.effect == effect){ ++playing; }
+                // the stolen voice is the one with the lowest priority, the oldest among equals
+                const SoundEffect &busy = SOUND_EFFECTS[voice.effect];
+                if (busy.priority <= sfx.priority  and  (victim == nullptr  or  busy.priority < SOUND_EFFECTS[victim->effect].priority  
+                        or  (busy.priority == SOUND_EFFECTS[victim->effect].priority  and  voice.startedAt < victim->startedAt))){ 
+                    victim = &voice; 
+                }
+            }
+            if (playing >= sfx.maxVoices){ return; }
+            
+            Voice *voice = (freeVoice != nullptr)? freeVoice : victim;
+            if (voice == nullptr){ return; } // every voice plays something more important
+            
+            voice->sound.stop();
+            voice->sound.setBuffer(buffers[effect]);
+            voice->sound.setPitch(sfx.pitch);    voice->sound.setVolume(sfx.volume);
+            voice->sound.setLoop(sfx.loop);
+            voice->sound.play();
+            voice->effect = effect;              voice->startedAt = ++triggers;
+        }
+        void stop(std::uint8_t effect){
+            for (auto &voice : voices){ if (voice.effect == effect){ voice.sound.stop(); } }
+            if (streams[effect]){ streams[effect]->stop(); }
+        }
+        void mixerLoop(){
+            SoundCommand command;
+            while (not quit.load(std::memory_order_acquire)){
+                while (commands.pop(command)){ 
+                    if (not ready[command.sound].load(std::memory_order_acquire)){ 
+                        waiting[command.sound] = not command.stop  and  SOUND_EFFECTS[command.sound].loop;
+                    }
+                    else if (command.stop){ stop(command.sound); } 
+                    else { play(command.sound); } 
+                }
+                for (short int i = 0; i < SOUND_COUNT; ++i){
+                    if (waiting[i]  and  ready[i].load(std::memory_order_acquire)){ waiting[i] = false;  play(i); }
+                }
+                // sleeps until the next trigger, a loop waiting for its sound is woken by the loader; a trigger pushed
+                // before (sleeping) was set is seen by isEmpty, one pushed after it sees (sleeping) and wakes the mixer
+                std::unique_lock<std::mutex> hold(wakeLock);
+                sleeping.store(true, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wake.wait(hold, [this](){ return woken  or  not commands.isEmpty(); });
+                sleeping.store(false, std::memory_order_relaxed);
+                woken = false;
+            }
+            for (auto &voice : voices){ voice.sound.stop(); }
+            for (short int i = 0; i < SOUND_COUNT; ++i){ if (ready[i].load(std::memory_order_acquire)  and  streams[i]){ streams[i]->stop(); } }
+        }
+        
+        public : 
+        
+        AudioMixer() : quit(false), loaded(false), residentBytes(0), loadMicroseconds(0), streamedSounds(0) {
+            triggers = 0;   woken = false;   sleeping = false;
+            for (short int i = 0; i < SOUND_COUNT; ++i){ ready[i] = false;  waiting[i] = false; }
+            loaderThread = std::thread(&AudioMixer::loaderLoop, this);
+            mixerThread = std::thread(&AudioMixer::mixerLoop, this);
+        }
+        ~AudioMixer() noexcept {
+            quit.store(true, std::memory_order_release);
+            signal();
+            loaderThread.join();
+            mixerThread.join();
+        }
+        AudioMixer(const AudioMixer &) = delete;
+        AudioMixer& operator=(const AudioMixer &) = delete;
+        
+        // called by the game thread, a trigger is dropped when the queue is full instead of waiting
+        inline void trigger(SoundId sound){ commands.push(SoundCommand{ sound, false });  wakeIfSleeping(); }
+        inline void release(SoundId sound){ commands.push(SoundCommand{ sound, true });  wakeIfSleeping(); }
+        
+        inline bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+        inline std::uint64_t getResidentBytes() const { return residentBytes; }
+        inline double getLoadMilliseconds() const { return loadMicroseconds / 1000.0; }
+        inline unsigned int getStreamedCount() const { return streamedSounds; }
+    };
+    
+    
+    ////////////////////////////////// @c TEXTURE-CACHE //////////////////////////////////
     
     
-    class Animation { // use to create animation for the objects
+    class TextureCache { // keeps the textures within a memory budget, loading them when they are first needed
         
         private : 
         
-        short int curFrame;  float frameRate;
-        std::vector<sf::IntRect> frames; // this just stores the cords of frames
-        sf::Sprite sprite;               // to display the frame on screen
+        struct Entry { 
+            std::string file;  unsigned int downscale;  bool pinned, smooth;
+            sf::Texture texture;  bool resident = false, requested = false, decoded = false, decodeFailed = false, failureLogged = false;  
+            sf::Image image;  std::uint64_t lastUsed = 0;  std::size_t bytes = 0;
+        };
+        std::deque<Entry> entries;
+        std::size_t budgetBytes, residentBytes, externalBytes;
+        std::uint64_t frameNo;
+        
+        std::thread loader;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::vector<std::size_t> decodeQueue;
+        bool quit;
         /*
-        imgTobeAnimate : image which contains different view frames in a linear row
-        cordX, cordY   : the inital co-ordinates for the frames
-        frameW, frameH : each frame size
-        frameCount     : total how many frames possible in the image
-        frameRate      : determines the speed of frame changing
+        entries       : every texture the cache knows, a deque so the textures never move in memory
+        downscale     : the image is kept at 1/downscale of its size (the low resolution explosions)
+        pinned        : the texture is never evicted (the sprites), the others are evicted least recently
+                        used first when the budget is exceeded
+        externalBytes : textures owned by others (the atlas pages), they only count against the budget
+        loader        : decodes the requested images off the game thread, the main thread uploads them; an image
+                        which can not be decoded stays not resident (it is requested again) and is logged once
         */
+        static sf::Image downscaled(const sf::Image &image, unsigned int factor){
+            if (factor <= 1){ return image; }
+            unsigned int w = image.getSize().x / factor, h = image.getSize().y / factor, srcW = image.getSize().x;
+            const sf::Uint8 *src = image.getPixelsPtr();
+            std::vector<sf::Uint8> pixels(static_cast<std::size_t>(w) * h * 4);
+            // every pixel is the average of a (factor x factor) block
+            for (unsigned int y = 0; y < h; ++y){
+                for (unsigned int x = 0; x < w; ++x){
+                    for (unsigned int c = 0; c < 4; ++c){
+                        unsigned int sum = 0;
+                        for (unsigned int by = 0; by < factor; ++by){
+                            for (unsigned int bx = 0; bx < factor; ++bx){ sum += src[((y*factor + by) * srcW + x*factor + bx) * 4 + c]; }
+                        }
+                        pixels[(static_cast<std::size_t>(y) * w + x) * 4 + c] = static_cast<sf::Uint8>(sum / (factor * factor));
+                    }
+                }
+            }
+            sf::Image small;  small.create(w, h, pixels.data());
+            return small;
+        }
+        bool decode(const Entry &entry, sf::Image &into){
+            sf::Image image;
+            if (not image.loadFromFile(entry.file)){ return false; }
+            into = downscaled(image, entry.downscale);
+            return true;
+        }
+        void logFailure(Entry &entry){
+            if (not entry.failureLogged){ std::cerr << "can not load the texture " << entry.file << "\n";  entry.failureLogged = true; }
+        }
+        void loaderLoop(){
+            while (true){
+                Entry *entry;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    wake.wait(guard, [&]{ return quit  or  not decodeQueue.empty(); });
+                    if (quit){ return; }
+                    entry = &entries[decodeQueue.front()];  decodeQueue.erase(decodeQueue.begin());
+                }
+                sf::Image image;  
+                bool failed = not decode(*entry, image); // the file and the downscale of an entry never change
+                std::lock_guard<std::mutex> guard(lock);
+                entry->image = std::move(image);  entry->decoded = true;  entry->decodeFailed = failed;
+            }
+        }
+        // evicts the least recently used textures until (bytes) more fit in the budget, the textures used in
+        // this or the previous frame are kept because they may still be on the screen
+        void makeRoom(std::size_t bytes){
+            while (residentBytes + externalBytes + bytes > budgetBytes){
+                Entry *oldest = nullptr;
+                for (auto &entry : entries){
+                    if (not entry.resident  or  entry.pinned  or  entry.lastUsed + 1 >= frameNo){ continue; }
+                    if (oldest == nullptr  or  entry.lastUsed < oldest->lastUsed){ oldest = &entry; }
+                }
+                if (oldest == nullptr){ return; } // everything left is needed, the budget is exceeded
+                oldest->texture = sf::Texture();  oldest->resident = false;  oldest->requested = false;
+                residentBytes -= oldest->bytes;   oldest->bytes = 0;
+            }
+        }
+        void upload(Entry &entry, const sf::Image &image){
+            std::size_t bytes = static_cast<std::size_t>(image.getSize().x) * image.getSize().y * 4;
+            makeRoom(bytes);
+            entry.texture.loadFromImage(image);
+            entry.texture.setSmooth(entry.smooth);
+            entry.resident = true;  entry.bytes = bytes;  entry.lastUsed = frameNo;
+            residentBytes += bytes;
+        }
+        
         public : 
         
-        Animation(sf::Texture &imgTobeAnimate, int cordX, int cordY, 
-                int frameW, int frameH, int frameCount, float frameSpeed) noexcept {
-            
-            curFrame = 0;           // start from the first most frame
-            frameRate = frameSpeed; // set the frame changing speed
-            
-            for (short int i = 0; i < frameCount; ++i){
-                frames.push_back(sf::IntRect(cordX + i*frameW, cordY, frameW, frameH));
-                // cordX + frameW * i = goto the next frame(frame cordX = frame size * frame no.)
-            }
-            sprite.setTexture(imgTobeAnimate);
-            sprite.setOrigin(frameW / 2, frameH / 2); // set orgin for smooth rotations for rotable objects
-            sprite.setTextureRect(frames[0]);         // set the initial frame to the sprite obj
+        TextureCache(std::size_t budget) : budgetBytes(budget) {
+            residentBytes = externalBytes = 0;  frameNo = 1;  quit = false;
+            loader = std::thread(&TextureCache::loaderLoop, this);
         }
-        Animation() noexcept { curFrame = frameRate = 0; }
-        ~Animation() noexcept {}
+        ~TextureCache() noexcept {
+            { std::lock_guard<std::mutex> guard(lock);  quit = true; }
+            wake.notify_all();
+            loader.join();
+        }
+        TextureCache(const TextureCache &) = delete;
+        TextureCache& operator=(const TextureCache &) = delete;
         
+        // registers a texture, nothing is loaded yet
+        std::size_t add(const std::string &file, bool pinned, bool smooth, unsigned int downscale = 1){
+            std::lock_guard<std::mutex> guard(lock);
+            entries.emplace_back();
+            Entry &entry = entries.back();
+            entry.file = file;  entry.pinned = pinned;  entry.smooth = smooth;  entry.downscale = std::max(1U, downscale);
+            return entries.size() - 1;
+        }
+        // loads the texture now (the textures needed before the first frame)
+        const sf::Texture& load(std::size_t id){
+            Entry &entry = entries[id];
+            if (not entry.resident){ 
+                sf::Image image;  
+                if (decode(entry, image)){ upload(entry, image); } else { logFailure(entry); }
+            }
+            entry.lastUsed = frameNo;
+            return entry.texture;
+        }
+        // asks the loader thread to decode the texture, it becomes resident in a later (update)
+        void request(std::size_t id){
+            Entry &entry = entries[id];
+            if (entry.resident  or  entry.requested){ return; }
+            entry.requested = true;
+            { std::lock_guard<std::mutex> guard(lock);  decodeQueue.push_back(id); }
+            wake.notify_one();
+        }
+        // the texture when it is resident, otherwise nullptr (then it is requested)
+        const sf::Texture* find(std::size_t id){
+            Entry &entry = entries[id];
+            if (not entry.resident){ request(id);  return nullptr; }
+            entry.lastUsed = frameNo;
+            return &entry.texture;
+        }
+        // called once a frame, uploads the images the loader has decoded
         void update(){
-            curFrame += frameRate; // increment the frames in timely manner
-            // if the current frame reach to the last then restart
-            if (curFrame >= frames.size()){ curFrame -= frames.size(); }
-            // set the currrent frame to the sprite obj 
-            if (frames.size() > 0){ sprite.setTextureRect(frames[curFrame]); }
+            ++frameNo;
+            for (auto &entry : entries){
+                sf::Image image;
+                bool failed;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (not entry.decoded){ continue; }
+                    image = std::move(entry.image);  entry.decoded = false;  failed = entry.decodeFailed;
+                }
+                if (failed){ logFailure(entry);  entry.requested = false;  continue; }
+                if (entry.requested  and  not entry.resident){ upload(entry, image);  entry.requested = false; }
+            }
         }
-        // checks if the animations is over or not
-        // if the current frame reached the last frame then animation over
-        inline bool isEnd(){ return (curFrame + frameRate  >=  frames.size()); }
-        inline sf::Sprite& getSprite(){ return sprite; }
+        
+        inline void setExternalBytes(std::size_t bytes){ externalBytes = bytes; }
+        inline std::size_t getResidentBytes() const { return residentBytes + externalBytes; }
+        inline std::size_t getBudgetBytes() const { return budgetBytes; }
+    };
+    
+    
+    ////////////////////////////////// @c SPECTATOR-STREAM //////////////////////////////////
+    
+    
+    // the state a spectator sees, the entities are quantized : the position in 1/65535 steps of the world
+    // and the angle in 256 steps, so an entity which did not move between two snapshots costs nothing
+    struct SnapshotInfo { 
+        std::uint32_t tick;  std::uint16_t worldW, worldH, simulationRate;  std::int16_t score, health, wave; 
     };
+    struct SnapshotEntity { std::uint32_t id;  std::uint16_t x, y;  std::uint8_t angle, frame, clip; };
+    struct Snapshot { SnapshotInfo info{};  std::vector<SnapshotEntity> entities; }; // the entities are sorted by id
     
+    // an entity as the game thread copies it, the quantizing and everything else is left to the publisher thread
+    struct CapturedEntity { std::uint32_t id;  float x, y, angle, playhead;  std::uint8_t clip; };
     
-    //////////////////////////////////// @c GAME-OBJECTS //////////////////////////////////
+    enum SnapshotField : std::uint8_t { FIELD_X = 1, FIELD_Y = 2, FIELD_ANGLE = 4, FIELD_FRAME = 8, FIELD_CLIP = 16, ALL_FIELDS = 31 };
+    const std::uint8_t SNAPSHOT_VERSION = 1, SNAPSHOT_DATAGRAM = 1, ACK_DATAGRAM = 2;
+    const std::size_t FRAGMENT_BYTES = 1200;      // payload of a datagram, below the usual MTU so a LAN does not split it
+    const std::size_t FRAGMENT_HEADER = 9;        // kind, tick, fragment index, fragment count
+    const std::size_t SNAPSHOT_HISTORY = 32;      // snapshots kept on both sides as the bases of the deltas
     
+    inline void putBytes(std::vector<std::uint8_t> &out, std::uint32_t value, int bytes){
+        for (int i = 0; i < bytes; ++i){ out.push_back(static_cast<std::uint8_t>(value >> (8 * i))); } // little endian
+    }
+    inline void putVarint(std::vector<std::uint8_t> &out, std::uint32_t value){
+        for (; value >= 0x80; value >>= 7){ out.push_back(static_cast<std::uint8_t>(value | 0x80)); }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+    inline std::uint32_t readBytes(const std::uint8_t *from, int bytes){
+        std::uint32_t value = 0;
+        for (int i = 0; i < bytes; ++i){ value |= static_cast<std::uint32_t>(from[i]) << (8 * i); }
+        return value;
+    }
     
-    class GameObject { // a base class for all movable game objects
-        friend void Main();
-        friend bool isCollided(const std::shared_ptr<GameObject>&, const std::shared_ptr<GameObject>&);
+    class ByteReader { // reads a message, reading past its end only sets (failed)
         
-        protected : 
+        private : 
+        
+        const std::uint8_t *at, *end;
+        bool failed;
         
-        bool life;
-        sf::String name;
-        float x, y, dx, dy, angle, R;
-        Animation animation;
-        /*
-        name         : a particular name that defines the object
-        life         : that defines the object is collided and alive or not
-        x , y        : current co-ordinates of the object
-        dx , dy      : future co-ordinates of the object
-        angle        : a angle in which direction the object is moving
-        animation    : to define the animations of the objects
-        R            : a optional value for visualizing collisions
-        */
-        GameObject(sf::String &&objName) noexcept { 
-            name = objName;  life = true;  x = y = dx = dy = angle = R = 0.0F; 
-        }
         public : 
         
-        virtual ~GameObject() noexcept {};
-        virtual void update(){};
+        ByteReader(const std::uint8_t *data, std::size_t size) noexcept { at = data;  end = data + size;  failed = false; }
+        ~ByteReader() noexcept {}
         
-        void settings(Animation &anim, int X, int Y, float degree = 1, int radious = 0){
-            animation = anim;  x = X;  y = Y;  angle = degree;  R = radious;
+        std::uint32_t bytes(int count){
+            if (end - at < count){ failed = true;  return 0; }
+            std::uint32_t value = readBytes(at, count);
+            at += count;
+            return value;
         }
-        void draw(sf::RenderWindow &window){    // draw the obj to the window
-            this->animation.getSprite().setPosition(x, y);
-            this->animation.getSprite().setRotation(angle + 90.0F);
-            window.draw(animation.getSprite()); // draw a particular frame to the window
-            
-            sf::CircleShape circle(R);
-            circle.setPosition(x, y);
-            circle.setOrigin(R, R);
-            // ------ optional part for debugging collison detections -------
-            // circle.setFillColor(sf::Color::Cyan);
-            // window.draw(circle);
+        std::uint32_t varint(){
+            std::uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7){
+                if (at == end){ failed = true;  return 0; }
+                std::uint8_t byte = *at++;
+                value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+                if (not (byte & 0x80)){ return value; }
+            }
+            failed = true;  return 0;
         }
+        inline bool isValid() const { return not failed; }
     };
     
+    // walks two sorted entity lists together : (removed) gets the ids of (baseline) missing in (snapshot), (present)
+    // gets every entity of (snapshot) with its entity in (baseline) or nullptr when it is new
+    template <typename Removed, typename Present>
+    void diffSnapshots(const Snapshot *baseline, const Snapshot &snapshot, Removed &&removed, Present &&present){
+        std::size_t b = 0, baseCount = (baseline != nullptr)? baseline->entities.size() : 0;
+        for (const auto &entity : snapshot.entities){
+            while (b < baseCount  and  baseline->entities[b].id < entity.id){ removed(baseline->entities[b++].id); }
+            const SnapshotEntity *old = (b < baseCount  and  baseline->entities[b].id == entity.id)? &baseline->entities[b++] : nullptr;
+            present(entity, old);
+        }
+        while (b < baseCount){ removed(baseline->entities[b++].id); }
+    }
+    inline std::uint8_t changedFields(const SnapshotEntity &entity, const SnapshotEntity *old){
+        if (old == nullptr){ return ALL_FIELDS; }
+        return (entity.x != old->x) * FIELD_X  |  (entity.y != old->y) * FIELD_Y  |  (entity.angle != old->angle) * FIELD_ANGLE 
+             | (entity.frame != old->frame) * FIELD_FRAME  |  (entity.clip != old->clip) * FIELD_CLIP;
+    }
+    
+    // writes (snapshot) as the changes from (baseline), or all of it when there is no baseline
+    // message : the version, the tick, the baseline tick (0 = none), the SnapshotInfo fields, the removed ids, 
+    //           then the changed entities, each with its id, a byte of SnapshotField bits and the changed fields;
+    //           the ids are written as the difference to the previous id (varints), so a sorted list stays small
+    void encodeSnapshot(const Snapshot &snapshot, const Snapshot *baseline, std::vector<std::uint8_t> &out){
+        const SnapshotInfo &info = snapshot.info;
+        out.clear();
+        out.push_back(SNAPSHOT_VERSION);
+        putBytes(out, info.tick, 4);          putBytes(out, (baseline != nullptr)? baseline->info.tick : 0, 4);
+        putBytes(out, info.worldW, 2);        putBytes(out, info.worldH, 2);     putBytes(out, info.simulationRate, 2);
+        putBytes(out, static_cast<std::uint16_t>(info.score), 2);   putBytes(out, static_cast<std::uint16_t>(info.health), 2);
+        putBytes(out, static_cast<std::uint16_t>(info.wave), 2);
+        
+        std::uint32_t removedCount = 0, changedCount = 0, previousId = 0;
+        diffSnapshots(baseline, snapshot, [&](std::uint32_t){ ++removedCount; }, 
+                      [&](const SnapshotEntity &entity, const SnapshotEntity *old){ changedCount += (changedFields(entity, old) != 0); });
+        
+        putVarint(out, removedCount);
+        diffSnapshots(baseline, snapshot, [&](std::uint32_t id){ putVarint(out, id - previousId);  previousId = id; }, 
+                      [](const SnapshotEntity &, const SnapshotEntity *){});
+        putVarint(out, changedCount);
+        previousId = 0;
+        diffSnapshots(baseline, snapshot, [](std::uint32_t){}, [&](const SnapshotEntity &entity, const SnapshotEntity *old){
+            std::uint8_t fields = changedFields(entity, old);
+            if (fields == 0){ return; }
+            putVarint(out, entity.id - previousId);   previousId = entity.id;
+            out.push_back(fields);
+            if (fields & FIELD_X){ putBytes(out, entity.x, 2); }
+            if (fields & FIELD_Y){ putBytes(out, entity.y, 2); }
+            if (fields & FIELD_ANGLE){ out.push_back(entity.angle); }
+            if (fields & FIELD_FRAME){ out.push_back(entity.frame); }
+            if (fields & FIELD_CLIP){ out.push_back(entity.clip); }
+        });
+    }
+    
+    // the baseline tick a message was encoded against (0 when it holds the full snapshot)
+    inline std::uint32_t baselineTickOf(const std::uint8_t *message, std::size_t size){ return (size >= 9)? readBytes(message + 5, 4) : 0; }
     
-    ////////////////////////////////// @c SPACESHIP-CLASS //////////////////////////////////
+    // rebuilds a snapshot from a message and the (baseline) it names, (changed) is a reused scratch list,
+    // returns false for a broken message or a wrong baseline
+    bool decodeSnapshot(const std::uint8_t *message, std::size_t size, const Snapshot *baseline, 
+                        Snapshot &out, std::vector<SnapshotEntity> &changed, std::vector<std::uint32_t> &removed){
+        ByteReader in(message, size);
+        if (in.bytes(1) != SNAPSHOT_VERSION){ return false; }
+        SnapshotInfo &info = out.info;
+        info.tick = in.bytes(4);
+        std::uint32_t baselineTick = in.bytes(4);
+        if (baselineTick != 0  and  (baseline == nullptr  or  baseline->info.tick != baselineTick)){ return false; }
+        if (baselineTick == 0){ baseline = nullptr; }
+        info.worldW = in.bytes(2);   info.worldH = in.bytes(2);   info.simulationRate = in.bytes(2);
+        info.score  = static_cast<std::int16_t>(in.bytes(2));     info.health = static_cast<std::int16_t>(in.bytes(2));
+        info.wave   = static_cast<std::int16_t>(in.bytes(2));
+        
+        removed.clear();   changed.clear();
+        std::uint32_t count = in.varint(), id = 0;
+        for (std::uint32_t i = 0; i < count  and  in.isValid(); ++i){ id += in.varint();  removed.push_back(id); }
+        count = in.varint();   id = 0;
+        for (std::uint32_t i = 0; i < count  and  in.isValid(); ++i){
+            id += in.varint();
+            std::uint8_t fields = in.bytes(1);
+            // an entity missing in the baseline has to come with all its fields
+            auto old = (baseline != nullptr)? std::lower_bound(baseline->entities.begin(), baseline->entities.end(), id, 
+                                                  [](const SnapshotEntity &e, std::uint32_t i){ return e.id < i; }) 
+                                             : std::vector<SnapshotEntity>::const_iterator();
+            bool known = (baseline != nullptr)  and  old != baseline->entities.end()  and  old->id == id;
+            if (not known  and  fields != ALL_FIELDS){ return false; }
+            
+            SnapshotEntity entity = known? *old : SnapshotEntity{ id, 0, 0, 0, 0, 0 };
+            if (fields & FIELD_X){ entity.x = in.bytes(2); }
+            if (fields & FIELD_Y){ entity.y = in.bytes(2); }
+            if (fields & FIELD_ANGLE){ entity.angle = in.bytes(1); }
+            if (fields & FIELD_FRAME){ entity.frame = in.bytes(1); }
+            if (fields & FIELD_CLIP){ entity.clip = in.bytes(1); }
+            changed.push_back(entity);
+        }
+        if (not in.isValid()){ return false; }
+        
+        // the baseline without the removed entities, with the changed ones replaced or added (all sorted by id)
+        out.entities.clear();
+        std::size_t b = 0, c = 0, r = 0, baseCount = (baseline != nullptr)? baseline->entities.size() : 0;
+        while (b < baseCount  or  c < changed.size()){
+            if (b == baseCount  or  (c < changed.size()  and  changed[c].id <= baseline->entities[b].id)){
+                if (b < baseCount  and  changed[c].id == baseline->entities[b].id){ ++b; }
+                out.entities.push_back(changed[c++]);
+                continue;
+            }
+            const SnapshotEntity &old = baseline->entities[b++];
+            if (r < removed.size()  and  removed[r] == old.id){ ++r;  continue; }
+            out.entities.push_back(old);
+        }
+        return r == removed.size();
+    }
     
     
-    class SpaceShip : public GameObject {
+    class SpectatorPublisher { // streams the world to one spectator over UDP, the encoding and the socket run on its own thread
         
-        public  :
+        private : 
         
-        SpaceShip() noexcept : GameObject("spaceship"){}
-        ~SpaceShip() noexcept {}
+        sf::UdpSocket socket;
+        bool opened, quit, hasPending;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::vector<CapturedEntity> captured, pending, working;
+        SnapshotInfo pendingInfo;
+        Snapshot history[SNAPSHOT_HISTORY];
+        std::vector<std::uint8_t> message;
+        sf::IpAddress viewer;
+        unsigned short viewerPort;
+        std::atomic<bool> hasViewer;
+        std::uint32_t lastAck, lastSentTick;
+        sf::Clock sinceHeard;
+        std::atomic<std::uint64_t> bytesSent, ticksSent;
+        std::atomic<std::uint32_t> lastMessageBytes;
+        std::thread thread;
+        /*
+        captured    : filled by the game thread, then swapped with (pending), the publisher thread swaps (pending)
+                      with (working), so the game thread only copies floats and never waits for the encoding;
+                      a snapshot not taken before the next one arrives is skipped
+        history     : the last snapshots sent, by tick, the one the spectator acknowledged last is the delta base
+        viewer      : the spectator, the last address which sent an ack, it is dropped after 2 seconds of silence,
+                      (hasViewer) is written by the publisher thread and read by the stats of the game thread
+        bytesSent   : bytes sent for (ticksSent) ticks of the game, the bandwidth shown in the stats
+        */
         
-        void update(){
-            if (spaceshipBoost){ // if user boosted the ship by up-arraow then increase speed
-                dx += std::cos(angle * DEG_TO_RAD) * 0.2F;
-                dy += std::sin(angle * DEG_TO_RAD) * 0.2F;
+        // the quantized, sorted snapshot of the (working) entities
+        void quantize(const SnapshotInfo &info, Snapshot &snapshot){
+            snapshot.info = info;
+            snapshot.entities.clear();
+            float stepsX = 65535.0F / std::max<int>(info.worldW, 1), stepsY = 65535.0F / std::max<int>(info.worldH, 1);
+            for (const auto &e : working){
+                float degree = std::fmod(e.angle, 360.0F);
+                snapshot.entities.push_back(SnapshotEntity{ e.id, 
+                    static_cast<std::uint16_t>(std::lrint(std::min(65535.0F, std::max(0.0F, e.x * stepsX)))),
+                    static_cast<std::uint16_t>(std::lrint(std::min(65535.0F, std::max(0.0F, e.y * stepsY)))),
+                    static_cast<std::uint8_t>(std::lrint((degree < 0.0F? degree + 360.0F : degree) * (256.0F / 360.0F)) & 255),
+                    static_cast<std::uint8_t>(e.playhead), e.clip });
             }
-            else { dx *= 0.99F;  dy *= 0.99F; } // otherwise decrease the speed gradually
-            
-            // prevent the ship speed to become too much fast
-            float maxSpeed = 5.0F, speed = std::sqrt(dx * dx  +  dy * dy);
-            if (speed > maxSpeed){ dx *= maxSpeed / speed;  dy *= maxSpeed / speed; }
+            std::sort(snapshot.entities.begin(), snapshot.entities.end(), 
+                        [](const SnapshotEntity &e1, const SnapshotEntity &e2){ return e1.id < e2.id; });
+        }
+        
+        void receiveAcks(){
+            std::uint8_t datagram[8];
+            std::size_t received;   sf::IpAddress from;   unsigned short port;
+            while (socket.receive(datagram, sizeof(datagram), received, from, port) == sf::Socket::Done){
+                if (received != 5  or  datagram[0] != ACK_DATAGRAM){ continue; }
+                std::uint32_t ack = readBytes(datagram + 1, 4);
+                // a new spectator, or an ack of 0 (a spectator saying hello), starts again from a full snapshot
+                if (not hasViewer  or  from != viewer  or  port != viewerPort  or  ack == 0){ 
+                    viewer = from;   viewerPort = port;   hasViewer = true;   lastAck = lastSentTick = 0; 
+                }
+                lastAck = std::max(lastAck, ack);
+                sinceHeard.restart();
+            }
+            if (hasViewer  and  sinceHeard.getElapsedTime() > sf::seconds(2)){ hasViewer = false; }
+        }
+        
+        void send(const SnapshotInfo &info){
+            // the acknowledged snapshot is the baseline while the history still has it
+            const Snapshot *baseline = nullptr;
+            const Snapshot &acked = history[lastAck % SNAPSHOT_HISTORY];
+            if (lastAck != 0  and  acked.info.tick == lastAck  and  info.tick - lastAck < SNAPSHOT_HISTORY){ baseline = &acked; }
             
-            x += dx;  y += dy;
+            Snapshot &snapshot = history[info.tick % SNAPSHOT_HISTORY];
+            quantize(info, snapshot);
+            encodeSnapshot(snapshot, baseline, message);
             
-            // screen wrapping 
-            // if the ship moves off one side of the screen then it reappears on other side
-            if (x < 0.0F){ x = imgBack.getSize().x; }
-            if (y < 0.0F){ y = imgBack.getSize().y; }
-            if (x > imgBack.getSize().x){ x = 0.0F; }
-            if (y > imgBack.getSize().y){ y = 0.0F; }
+            // the message split into datagrams, the spectator puts them together by the tick
+            std::uint8_t datagram[FRAGMENT_HEADER + FRAGMENT_BYTES];
+            std::size_t fragments = (message.size() + FRAGMENT_BYTES - 1) / FRAGMENT_BYTES;
+            for (std::size_t f = 0; f < fragments; ++f){
+                std::size_t bytes = std::min(FRAGMENT_BYTES, message.size() - f * FRAGMENT_BYTES);
+                datagram[0] = SNAPSHOT_DATAGRAM;
+                for (int i = 0; i < 4; ++i){ datagram[1 + i] = static_cast<std::uint8_t>(info.tick >> (8 * i)); }
+                datagram[5] = static_cast<std::uint8_t>(f);          datagram[6] = static_cast<std::uint8_t>(f >> 8);
+                datagram[7] = static_cast<std::uint8_t>(fragments);  datagram[8] = static_cast<std::uint8_t>(fragments >> 8);
+                std::copy_n(message.data() + f * FRAGMENT_BYTES, bytes, datagram + FRAGMENT_HEADER);
+                socket.send(datagram, FRAGMENT_HEADER + bytes, viewer, viewerPort);
+            }
+            bytesSent += message.size() + fragments * FRAGMENT_HEADER;
+            ticksSent += (lastSentTick != 0)? info.tick - lastSentTick : 1;
+            lastSentTick = info.tick;
+            lastMessageBytes = static_cast<std::uint32_t>(message.size());
+        }
+        
+        void run(){
+            SnapshotInfo info;
+            while (true){
+                bool taken = false;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    // the acks are read at least every few milliseconds, also when the game is paused
+                    wake.wait_for(guard, std::chrono::milliseconds(5), [&]{ return quit  or  hasPending; });
+                    if (quit){ return; }
+                    if (hasPending){ std::swap(pending, working);  info = pendingInfo;  hasPending = false;  taken = true; }
+                }
+                receiveAcks();
+                if (taken  and  hasViewer){ send(info); }
+            }
         }
-    };
-    
-    
-    ////////////////////////////////// @c BULLET-CLASS //////////////////////////////////
-    
-    
-    class Bullet : public GameObject {
         
         public : 
         
-        Bullet() noexcept : GameObject("bullet"){}
-        ~Bullet() noexcept {}
+        SpectatorPublisher(unsigned short port) : hasViewer(false), bytesSent(0), ticksSent(0), lastMessageBytes(0) {
+            quit = hasPending = false;
+            viewerPort = 0;   lastAck = lastSentTick = 0;
+            opened = (socket.bind(port) == sf::Socket::Done);
+            if (not opened){ std::cerr << "can not publish the spectator stream on port " << port << "\n";  return; }
+            socket.setBlocking(false);
+            thread = std::thread(&SpectatorPublisher::run, this);
+        }
+        ~SpectatorPublisher(){
+            if (not opened){ return; }
+            { std::lock_guard<std::mutex> guard(lock);  quit = true; }
+            wake.notify_one();
+            thread.join();
+        }
         
-        void update(){
-            dx += std::cos(angle * DEG_TO_RAD) * 1.0F; // calculate the velocity horizontal
-            dy += std::sin(angle * DEG_TO_RAD) * 1.0F; // calculate the velocity vertically
-            x += dx;   y += dy;                        // updae to the actual co-ordinates
-            // change the fire types but not effect the single fire type 
-            if (fireType == 2  and  R == 11){ angle += randNo(randGen) % 7 - 3; }
-            if (fireType == 3  and  R == 11){ angle += randNo(randGen); }
-            // if go out of bound then remove that bullet obj
-            if (x < 0  or  x > imgBack.getSize().x){ life = false; }
-            if (y < 0  or  y > imgBack.getSize().y){ life = false; }
+        // called by the game thread after a tick, copies the entities for the publisher thread
+        void publish(const World &world){
+            if (not opened){ return; }
+            captured.clear();
+            for (auto type : { SPACESHIP, BULLET, ASTEROID, EXPLOSION, HUNTER }){
+                const EntityPool &pool = world.gameObjs[type];
+                for (std::size_t i = 0; i < pool.size(); ++i){
+                    // the handle slot keeps the id of an entity while it moves inside its pool
+                    std::uint32_t slot = pool.handleSlot[i];
+                    captured.push_back(CapturedEntity{ slot << 12 | (world.gameObjs.generationOf(slot) & 0xFFF), 
+                                                       pool.x[i], pool.y[i], pool.angle[i], pool.playhead[i], pool.clip[i] });
+                }
+            }
+            SnapshotInfo info{ static_cast<std::uint32_t>(world.tickNo), static_cast<std::uint16_t>(worldW), 
+                               static_cast<std::uint16_t>(worldH), static_cast<std::uint16_t>(simulationRate), 
+                               world.playerScore, world.playerHealthCount, world.waveNo };
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                std::swap(captured, pending);   pendingInfo = info;   hasPending = true;
+            }
+            wake.notify_one();
         }
+        
+        inline bool isOpen() const { return opened; }
+        inline bool isWatched() const { return hasViewer; }
+        inline double getBytesPerTick() const { return static_cast<double>(bytesSent) / std::max<std::uint64_t>(ticksSent, 1); }
+        inline std::uint32_t getLastMessageBytes() const { return lastMessageBytes; }
     };
     
     
-    ////////////////////////////////// @c ASTEROID-CLASS //////////////////////////////////
-    
-    
-    class Asteroid : public GameObject {
+    class SpectatorReceiver { // the spectator side of the stream : puts the datagrams together and decodes the snapshots
+        
+        private : 
         
-        public :
+        sf::UdpSocket socket;
+        sf::IpAddress host;
+        unsigned short port;
+        Snapshot history[SNAPSHOT_HISTORY];
+        Snapshot decoded;
+        std::vector<SnapshotEntity> changed;
+        std::vector<std::uint32_t> removed;
+        std::vector<std::uint8_t> message, arrived;
+        std::uint32_t newestTick, messageTick;
+        std::size_t fragmentCount, fragmentsLeft, messageBytes;
+        sf::Clock sinceHello, sinceSnapshot;
+        std::uint64_t bytesReceived, snapshotsReceived;
+        /*
+        history    : the decoded snapshots by tick, they are the bases of the next deltas and are drawn blended
+        message    : the snapshot of (messageTick) being put together, (arrived) marks its fragments
+        newestTick : the newest complete snapshot, older datagrams are ignored
+        */
+        void sendAck(std::uint32_t tick){
+            std::uint8_t datagram[5] = { ACK_DATAGRAM, static_cast<std::uint8_t>(tick),       static_cast<std::uint8_t>(tick >> 8),
+                                         static_cast<std::uint8_t>(tick >> 16), static_cast<std::uint8_t>(tick >> 24) };
+            socket.send(datagram, sizeof(datagram), host, port);
+        }
         
-        Asteroid() noexcept : GameObject("asteroid"){ 
-            dx = randNo(randGen) % 3; // spawn a asteroid with random values
-            dy = randNo(randGen) % 3; // (%5) to limit the asteroids movement speed
+        void complete(){
+            std::uint32_t baselineTick = baselineTickOf(message.data(), messageBytes);
+            const Snapshot *baseline = (baselineTick != 0)? find(baselineTick) : nullptr;
+            if (not decodeSnapshot(message.data(), messageBytes, baseline, decoded, changed, removed)){ return; }
+            std::swap(history[decoded.info.tick % SNAPSHOT_HISTORY], decoded);
+            newestTick = messageTick;   ++snapshotsReceived;
+            sinceSnapshot.restart();
+            sendAck(newestTick);
         }
-        ~Asteroid() noexcept {}
         
-        void update(){
-            x += dx;   y += dy; // update the actual co-ordinates
-            // screen wrapping (same like the spaceship)
-            if (x < 0.0F){ x = imgBack.getSize().x; }
-            if (y < 0.0F){ y = imgBack.getSize().y; }
-            if (x > imgBack.getSize().x){ x = 0.0F; }
-            if (y > imgBack.getSize().y){ y = 0.0F; }
+        public : 
+        
+        SpectatorReceiver(const sf::IpAddress &gameHost, unsigned short gamePort){
+            host = gameHost;   port = gamePort;
+            newestTick = messageTick = 0;   fragmentCount = fragmentsLeft = messageBytes = 0;
+            bytesReceived = snapshotsReceived = 0;
+            socket.bind(sf::Socket::AnyPort);
+            socket.setBlocking(false);
+            sendAck(0); // hello
+        }
+        ~SpectatorReceiver() noexcept {}
+        
+        // reads the waiting datagrams, called once a frame
+        void poll(){
+            std::uint8_t datagram[FRAGMENT_HEADER + FRAGMENT_BYTES];
+            std::size_t received;   sf::IpAddress from;   unsigned short fromPort;
+            while (socket.receive(datagram, sizeof(datagram), received, from, fromPort) == sf::Socket::Done){
+                if (received <= FRAGMENT_HEADER  or  datagram[0] != SNAPSHOT_DATAGRAM){ continue; }
+                bytesReceived += received;
+                std::uint32_t tick = readBytes(datagram + 1, 4);
+                std::size_t index = readBytes(datagram + 5, 2), count = readBytes(datagram + 7, 2), bytes = received - FRAGMENT_HEADER;
+                if (tick <= newestTick  or  tick < messageTick  or  index >= count){ continue; } // late
+                if (tick != messageTick){ // the first datagram of a newer snapshot, an unfinished one is given up
+                    messageTick = tick;   fragmentCount = fragmentsLeft = count;   messageBytes = 0;
+                    arrived.assign(count, 0);   message.resize(count * FRAGMENT_BYTES);
+                }
+                // only the last fragment may be shorter
+                if (count != fragmentCount  or  arrived[index]  or  (index + 1 < count  and  bytes != FRAGMENT_BYTES)){ continue; }
+                arrived[index] = 1;
+                std::copy_n(datagram + FRAGMENT_HEADER, bytes, message.begin() + index * FRAGMENT_BYTES);
+                messageBytes += bytes;
+                if (--fragmentsLeft == 0){ complete(); }
+            }
+            // say hello until the stream comes, and again when it stopped (a restarted game counts the ticks from 1)
+            if (sinceSnapshot.getElapsedTime() > sf::seconds(2)){ newestTick = messageTick = 0; }
+            if (newestTick == 0  and  sinceHello.getElapsedTime() > sf::seconds(0.5F)){ sendAck(0);  sinceHello.restart(); }
         }
-    };
-    
-    
-    ////////////////////////////////// @c EXPLOSION-CLASS //////////////////////////////////
-    
-    
-    class Explosion : public GameObject {  public :
         
-        Explosion() noexcept : GameObject("explosion"){}
-        ~Explosion() noexcept {}
+        // the snapshot of a tick, nullptr when it was not received
+        const Snapshot* find(std::uint32_t tick) const {
+            const Snapshot &snapshot = history[tick % SNAPSHOT_HISTORY];
+            return (tick != 0  and  snapshot.info.tick == tick)? &snapshot : nullptr;
+        }
+        inline std::uint32_t getNewestTick() const { return newestTick; }
+        inline double getBytesPerSnapshot() const { return static_cast<double>(bytesReceived) / std::max<std::uint64_t>(snapshotsReceived, 1); }
     };
     
     
-    ////////////////////////////////// @c COLLISION-DETECTION-FUNCTION //////////////////////////////////
-    
-    
-    bool isCollided(const std::shared_ptr<GameObject> &obj1, const std::shared_ptr<GameObject> &obj2){
-        
-        // collision check between two objs using maths ---circle distance formula---
-        auto distanceSquareX = (obj1->x - obj2->x) * (obj1->x - obj2->x);
-        auto distanceSquareY = (obj1->y - obj2->y) * (obj1->y - obj2->y);
-        auto distanceSquareR = (obj1->R + obj2->R) * (obj1->R + obj2->R); // R -> radious
+    // the sprite clips from the atlas pages (one upload), or when the atlas was not built from the sheets
+    // through the texture cache, returns true when the atlas is used
+    bool loadSpriteClips(TextureCache &textures, TextureAtlas &atlas, AnimationClip *clips){
+        bool atlasLoaded = atlas.load("Images/Asteroid/atlas.txt")  and  createAtlasClips(atlas, clips);
+        if (atlasLoaded){ textures.setExternalBytes(atlas.getBytes());  return true; }
         
-        return (distanceSquareX + distanceSquareY  <  distanceSquareR);
+        std::size_t ids[ANIMATION_COUNT];
+        for (short int i = 0; i < ANIMATION_COUNT; ++i){
+            const SpriteSheet &sheet = SPRITE_SHEETS[i];
+            int downscale = (lowResExplosions  and  i == SHIP_EXPLOSION_ANIM)? 2 : 1;
+            // a sheet shared by two clips (the hunters fly the spaceship sheet) is loaded once
+            std::size_t id = SIZE_MAX;
+            for (short int j = 0; j < i; ++j){ if (std::strcmp(SPRITE_SHEETS[j].file, sheet.file) == 0){ id = ids[j]; } }
+            if (id == SIZE_MAX){ id = textures.add(sheet.file, true, i == SPACESHIP_ANIM  or  downscale > 1, downscale); }
+            ids[i] = id;
+            clips[i] = AnimationClip(textures.load(id), sheet.cordX, sheet.cordY, 
+                                        sheet.frameW, sheet.frameH, sheet.frameCount, sheet.frameSpeed, downscale);
+        }
+        return false;
     }
     
     
     void Main(){
         using namespace sf;
         
+        Clock startupClock; // the time until the window opens, for the stats
         Image       icon;  
-        Texture     imgStartUp, imgBack2, imgBack3, imgBack4, imgSpaceship, imgSpaceshipBoost, imgBlueFire, imgRedFire, 
-                    imgBigAsteroids, imgSmallAsteroids, imgExplosion1, imgExplosion2, imgExplosion3, imgHealth;
-        SoundBuffer explosion1SBuffer, shipBoostSBuffer, singleFireSBuffer, specialFireSBuffer1, specialFireSBuffer2;
+        Texture     imgHealth;
         
-        imgStartUp.loadFromFile         ("Images/Asteroid/startupimage.png");
         icon.loadFromFile               ("Images/Asteroid/icon.png");
-        imgBack.loadFromFile            ("Images/Asteroid/background.jpg");
-        imgBack2.loadFromFile           ("Images/Asteroid/background2.jpg");
-        imgBack3.loadFromFile           ("Images/Asteroid/background3.jpg");
-        imgBack4.loadFromFile           ("Images/Asteroid/background4.jpg");
-        imgSpaceship.loadFromFile       ("Images/Asteroid/spaceship2.png");
-        imgSpaceshipBoost.loadFromFile  ("Images/Asteroid/spaceship2_.png");
-        imgBlueFire.loadFromFile        ("Images/Asteroid/bluefire.png");
-        imgRedFire.loadFromFile         ("Images/Asteroid/redfire.png");
-        imgBigAsteroids.loadFromFile    ("Images/Asteroid/bigrocks.png");
-        imgSmallAsteroids.loadFromFile  ("Images/Asteroid/smallrocks.png");
-        imgExplosion1.loadFromFile      ("Images/Asteroid/explosion1.png");
-        imgExplosion2.loadFromFile      ("Images/Asteroid/explosion2.png");
-        imgExplosion3.loadFromFile      ("Images/Asteroid/explosion3.png");
-        imgHealth.loadFromFile          ("Images/Asteroid/heartimage.png");
-        explosion1SBuffer.loadFromFile  ("Sounds/Asteroid/explosionsound1.wav");
-        shipBoostSBuffer.loadFromFile   ("Sounds/Asteroid/thrustsound.wav");
-        singleFireSBuffer.loadFromFile  ("Sounds/Asteroid/weaponsound3.wav");
-        specialFireSBuffer1.loadFromFile("Sounds/Asteroid/weaponsound1.wav");
-        specialFireSBuffer2.loadFromFile("Sounds/Asteroid/weaponsound2.wav");
-        
-        imgBack.setSmooth     (true);    imgBack2.setSmooth(true);
-        imgBack3.setSmooth    (true);    imgBack4.setSmooth(true);
-        imgSpaceship.setSmooth(true);
+        
+        // the textures are loaded through the cache, only the background on the screen has to be resident
+        TextureCache textures(textureBudgetMB << 20);
+        const char *backgroundFiles[4] = { "Images/Asteroid/background.jpg",  "Images/Asteroid/background2.jpg",
+                                           "Images/Asteroid/background3.jpg", "Images/Asteroid/background4.jpg" };
+        std::size_t backgroundIds[4];
+        for (short int i = 0; i < 4; ++i){ backgroundIds[i] = textures.add(backgroundFiles[i], false, true); }
+        std::size_t shownBackground = backgroundIds[ith_background];
+        screenW = textures.load(shownBackground).getSize().x;   screenH = textures.load(shownBackground).getSize().y;
+        // the playfield is one screen, or a large world of screens
+        worldW = screenW * std::max(1, worldScreens);   worldH = screenH * std::max(1, worldScreens);
+        
+        // the sprites come from the atlas pages (one upload), or when the atlas was not built from the sheets
+        TextureAtlas atlas;
+        AnimationClip clips[ANIMATION_COUNT];
+        bool atlasLoaded = loadSpriteClips(textures, atlas, clips);
+        const std::vector<AtlasFrame> *heartFrame = atlasLoaded? atlas.find("Images/Asteroid/heartimage.png") : nullptr;
+        if (heartFrame == nullptr){ imgHealth.loadFromFile("Images/Asteroid/heartimage.png"); }
+        const Texture *heartTexture = (heartFrame != nullptr)? &atlas.getPage(heartFrame->front().page) : &imgHealth;
+        IntRect heartRect = (heartFrame != nullptr)? heartFrame->front().rect 
+                                                   : IntRect(0, 0, imgHealth.getSize().x, imgHealth.getSize().y);
         
         // ------------------- creating the main game window -------------------
-        RenderWindow window(VideoMode(imgBack.getSize().x, imgBack.getSize().y), "Asteroid !...");
+        RenderWindow window(VideoMode(screenW, screenH), "Asteroid !...");
         window.setIcon(icon.getSize().x, icon.getSize().y, icon.getPixelsPtr());
-        window.setFramerateLimit(120);
-        loadInitialImage(imgStartUp, window); // load the initial image for the game
-        
-        std::vector<Sprite>         background(4);
-        background[0].setTexture    (imgBack);
-        background[1].setTexture    (imgBack2);
-        background[2].setTexture    (imgBack3);
-        background[3].setTexture    (imgBack4);
-        Sprite playerHealth         (imgHealth);
-        
-        Animation spaceShipAnim     (imgSpaceship,      0, 0,  45,  50,  1, 1);
-        Animation spaceShipBoostAnim(imgSpaceshipBoost, 0, 0,  45,  70,  1, 1);
-        Animation blueBulletAnim    (imgBlueFire,       0, 0,  32,  64, 16, 1);
-        Animation redBulletAnim     (imgRedFire,        0, 0,  32,  64, 16, 0);
-        Animation bigAsteroidAnim   (imgBigAsteroids,   0, 0,  64,  64, 16, 0);
-        Animation smallAsteroidAnim (imgSmallAsteroids, 0, 0,  64,  64, 16, 0);
-        Animation explosionAnim_1   (imgExplosion1,     0, 0,  50,  50, 20, 1);
-        Animation explosionAnim_2   (imgExplosion2,     0, 0, 192, 192, 64, 1);
-        Animation explosionAnim_3   (imgExplosion3,     0, 0, 256, 256, 48, 1);
-        
-        Sound explosionSound1  (explosion1SBuffer);
-        Sound shipBoostSound   (shipBoostSBuffer);
-        Sound singleFireSound  (singleFireSBuffer);
-        Sound specialFireSound1(specialFireSBuffer1);
-        Sound specialFireSound2(specialFireSBuffer2);
-        
-        singleFireSound.setPitch  (2.0F);    singleFireSound.setVolume  (10.0F);
-        specialFireSound1.setPitch(2.0F);    specialFireSound1.setVolume(10.0F);
-        specialFireSound2.setPitch(2.0F);    specialFireSound2.setVolume(10.0F);
-        shipBoostSound.setPitch   (2.0F);    shipBoostSound.setVolume   (12.5F);
-        
-        // std::list<GameObject*> gameObjs;
-        std::list<std::shared_ptr<GameObject>> gameObjs;
-        
-        // GameObject *spaceshipObj = new SpaceShip(); // space ship obj
-        std::shared_ptr<GameObject> spaceshipObj = std::make_shared<SpaceShip>();
-        spaceshipObj->settings(spaceShipAnim, 400, 400, 0, 20);
-        gameObjs.push_back(spaceshipObj);
+        window.setFramerateLimit(static_cast<unsigned int>(renderRate));
+        Time startupTime = startupClock.getElapsedTime();
+        
+        // the sounds are decoded on a loader thread while the startup image shows
+        AudioMixer audio;           // plays the sounds on its own thread
+        audio.trigger(MUSIC_SOUND); // loops while the game runs, when there is a music file
+        {   // the startup image is only needed once
+            Texture imgStartUp;
+            imgStartUp.loadFromFile("Images/Asteroid/startupimage.png");
+            loadInitialImage(imgStartUp, window); // load the initial image for the game
+        }
+        Sprite background(textures.load(shownBackground));
+        
+        // a replay plays the recorded game instead of the keyboard, it starts exactly like the recorded game
+        InputReplay replay;
+        bool replaying = not replayFile.empty()  and  replay.load(replayFile);
+        RockHulls rockHulls;       // the hit shapes of the asteroids, circles when the hulls are not baked
+        bool hullsLoaded = rockHulls.load("Images/Asteroid/hulls.txt");
+        // a recording of other hit shapes is not replayed, the keyboard plays then
+        if (replaying  and  not applyRecordingHeader(replay.getHeader(), hullsLoaded? &rockHulls : nullptr)){ replaying = false; }
+        std::unique_ptr<InputRecorder> recorder;
+        if (not recordFile.empty()){ recorder.reset(new InputRecorder(recordFile, currentRecordingHeader(hullsLoaded? &rockHulls : nullptr))); }
+        
+        Scenario stressScenario;   // the spawn schedule of --scenario, the normal waves when it can not be read
+        bool scenarioLoaded = not scenarioFile.empty()  and  stressScenario.load(scenarioFile);
+        World world(clips, workerThreads, scenarioLoaded? &stressScenario : nullptr, hullsLoaded? &rockHulls : nullptr); // all the game objects and the game rules
+        SpriteBatch spriteBatch;   // draws the game objects texture by texture
+        VertexArray particleQuads(Quads); // all the explosion particles, one draw call
+        std::unique_ptr<SpectatorPublisher> spectators; // streams the ticks to a spectator (--publish)
+        if (spectatorPort != 0){ spectators.reset(new SpectatorPublisher(spectatorPort)); }
+        bool boostSoundOn = false; // the boost sound loops while the ship is boosted
+        
+        // a closed game is saved and goes on at the next start, a replayed or a recorded game always starts new
+        bool saving = not replaying  and  not recorder;
+        std::string lastSave; // the size and the time of the last save, shown by F3
+        auto save = [&](){
+            Clock saveClock;
+            std::size_t bytes = saveSession(world, saveFile);
+            lastSave = (bytes > 0)? std::to_string(bytes / 1024) + " KB in " + std::to_string(saveClock.getElapsedTime().asMicroseconds()) + " us" 
+                                  : "can not write " + saveFile;
+        };
+        if (saving){
+            Clock loadClock;
+            if (loadSession(world, resumeFile.empty()? saveFile : resumeFile)){ 
+                lastSave = "resumed at tick " + std::to_string(world.tickNo) + " in " + std::to_string(loadClock.getElapsedTime().asMicroseconds()) + " us"; 
+            }
+        }
         
         ///////////////////////////////// @c MAIN-LOOP /////////////////////////////////
         
         // if the players high score not set, then it means player plays the game for the first time
         bool gamePause = false, startUpInstructionsLoaded = (getGameScore("HighestScore")=="0")? false:true;
-        short int playerHealthCount = 5,  playerScore = 0, waveLength = 0, waveNo = 0;
-        Clock inputClock, fireClock, fireHoldClock;                            // timer clocks for hold inputs and 
-        bool inputBlocked = false, continiousFireOn = false, holdFire = false; // flags for timers
+        
+        // the simulation advances in fixed ticks, the time of each rendered frame is collected in
+        // the (accumulator) and consumed tick by tick, the remainder blends the drawing of the ticks
+        Clock frameClock;
+        const float tickTime = 1.0F / simulationRate;
+        float accumulator = 0.0F;
+        TickInput input; // the key presses are collected here until the next tick
+        View camera(FloatRect(0, 0, screenW, screenH)); // follows the ship in a large world
+        FloatRect cameraRect;
         
         Event e;
         while (window.isOpen()){
+            ASTEROID_PROFILE_MARK(INPUT_PHASE);
             while (window.pollEvent(e)){
-                if (e.type == Event::Closed){ window.close(); }
+                if (e.type == Event::Closed){ 
+                    if (saving  and  world.tickNo > 0){ save(); }
+                    window.close(); 
+                }
                 if (e.type == Event::LostFocus){ gamePause = true; }
                 if (e.type == Event::GainedFocus){ gamePause = false; }
                 
-                
-                ////////////////////////// @c DIFFERENT-TYPE-BULLET-SHOOT-LOGIC /////////////////////////
-                
-                
                 if (e.type == Event::KeyPressed){
-                    if (e.key.code == Keyboard::Space  and  not inputBlocked){ 
-                        
-                        // create a new single bullet obj on space key input
-                        std::shared_ptr<GameObject> bulletObj = std::make_shared<Bullet>();
-                        bulletObj->settings(blueBulletAnim, spaceshipObj->x, spaceshipObj->y, spaceshipObj->angle, 10);
-                        gameObjs.push_back(bulletObj);
-                        // play the single bullet fire sound
-                        // only play the sound if it is not the sound is currently playing 
-                        // (it actually maintain the sound effect properly)
-                        if (singleFireSound.getStatus() != Sound::Playing){ singleFireSound.play(); }
-                        else { singleFireSound.stop(); }
-                    }
+                    if (e.key.code == Keyboard::Space){ input.fireSingle = true; } // single bullet
                     // changes the fire type upon keyboard down key press
-                    else if (e.key.code == Keyboard::Down){ ++fireType;  if (fireType >= 4) fireType = 1; }
-                    
-                    else if (e.key.code == Keyboard::LShift  and  not continiousFireOn){
-                        fireClock.restart();  continiousFireOn = true; // shift hold for continious fire
-                    }
+                    else if (e.key.code == Keyboard::Down){ input.changeFireType = true; }
+                    // shift hold for continious fire
+                    else if (e.key.code == Keyboard::LShift){ input.continiousFire = true; }
+                    // show/hide the performance counters
+                    else if (e.key.code == Keyboard::F3){ showDebugStats = not showDebugStats; }
+                    // show/hide the time of each phase of the frame (ASTEROID_PROFILE builds)
+                    else if (e.key.code == Keyboard::F4){ showProfiler = not showProfiler; }
+                    // save a checkpoint now, the game goes on
+                    else if (e.key.code == Keyboard::F5  and  saving){ save(); }
                 }
                 if (e.type == Event::KeyReleased){ // shift released continious fire off
-                    if (e.key.code == Keyboard::LShift){ continiousFireOn = false; }
+                    if (e.key.code == Keyboard::LShift){ input.continiousFire = false; }
                 }
             }
             if (not startUpInstructionsLoaded){
@@ -352,179 +4253,276 @@ namespace Asteroid {
             }
             "----------------------------------- start game logic and calculations ---------------------------------";
             
-            if (not gamePause  and  not inHomePage){
-                
-                if (not inputBlocked  and  continiousFireOn  and  not holdFire){ 
-                    
-                    // create a new continious bullet obj
-                    std::shared_ptr<GameObject> bulletObj = std::make_shared<Bullet>();
-                    bulletObj->settings((fireType == 1)? blueBulletAnim : redBulletAnim, 
-                                        spaceshipObj->x, spaceshipObj->y, spaceshipObj->angle, 11);
-                    gameObjs.push_back(bulletObj);
-                    
-                    switch (fireType){ // play the continious fire sound based on the fire type
-                        case 1 :    if (specialFireSound1.getStatus() != Sound::Playing){ 
-                                        specialFireSound1.play(); 
-                                    } break;
-                        case 2 :    if (specialFireSound2.getStatus() != Sound::Playing){ 
-                                        specialFireSound2.play(); 
-                                    } break;
-                        case 3 :    if (specialFireSound2.getStatus() != Sound::Playing){ 
-                                        specialFireSound2.play(); 
-                                    } break;
-                    }
-                    // continue the continious fire upto 3 seonds then block it for recharge
-                    if (fireClock.getElapsedTime() >= seconds(3)){ 
-                        holdFire = true;  fireHoldClock.restart(); 
-                    }
-                }
-                else { // restart the continious fire after recharged for 10 seconds
-                    if (fireHoldClock.getElapsedTime() >= seconds(10)){ holdFire = false; }
-                }
+            // a long frame (like the window being dragged) is not caught up completely
+            accumulator += std::min(frameClock.restart().asSeconds(), 0.25F);
+            
+            if (gamePause  or  inHomePage){ 
+                accumulator = 0.0F;  input.fireSingle = input.changeFireType = false; 
+            }
+            while (accumulator >= tickTime){
+                accumulator -= tickTime;
                 
-                /////////////////////////// @c SHIP-MOVEMENT-LOGIC //////////////////////////
+                input.rotateRight = Keyboard::isKeyPressed(Keyboard::Right);
+                input.rotateLeft  = Keyboard::isKeyPressed(Keyboard::Left);
+                input.thrust      = Keyboard::isKeyPressed(Keyboard::Up);
+                if (replaying  and  not replay.next(input)){ window.close();  break; } // the recording is over
+                if (recorder){ recorder->record(input); }
+                ASTEROID_PROFILE_END_MARK();
                 
+                TickEvents events;
+                world.tick(input, events);
+                if (spectators){ spectators->publish(world); }
+                input.fireSingle = input.changeFireType = false; // these are consumed by one tick
+                ASTEROID_PROFILE_MARK(SOUND_PHASE);
                 
-                if (not inputBlocked  and  Keyboard::isKeyPressed(Keyboard::Right)){ spaceshipObj->angle += 2.9F; }
-                if (not inputBlocked  and  Keyboard::isKeyPressed(Keyboard::Left)){  spaceshipObj->angle -= 2.9F; }
-                // cahnging the space ship image based on enable/disable boost of the space ship
-                if (not inputBlocked  and  Keyboard::isKeyPressed(Keyboard::Up)){ 
-                    spaceshipBoost = true;  
-                    spaceshipObj->animation = spaceShipBoostAnim;
-                    // play the spaceship boost sound
-                    if (shipBoostSound.getStatus() != Sound::Playing){ shipBoostSound.play(); }
-                }
-                else { spaceshipBoost = false;  spaceshipObj->animation = spaceShipAnim;  shipBoostSound.stop(); }
                 
+                ///////////////////////////////// @c GAME-SOUNDS /////////////////////////////////
                 
-                ///////////////////////// @c COLLISION-DETECTION-LOGIC-AND-INPUT-HOLD ////////////////////////
                 
+                // the effects only queue a trigger, the mixer thread finds them a voice
+                if (events.singleFired){ audio.trigger(SINGLE_FIRE_SOUND); }
+                // the continious fire sound is based on the fire type
+                if (events.continiousFired){ audio.trigger((fireType == 1)? SPECIAL_FIRE_1_SOUND : SPECIAL_FIRE_2_SOUND); }
                 
-                for (auto &obj1 : gameObjs){
-                    for (auto &obj2 : gameObjs){
-                        
-                        if (obj1->name == "bullet"  and  obj2->name == "asteroid"){
-                            if ( isCollided(obj1, obj2) ){
-                                
-                                obj1->life = obj2->life = false; 
-                                // if R = 10, means it is already a small asteroid, so not break it furthur
-                                if (obj2->R != 10){ // this refer to big asteroids
-                                    obj2->name = "break_this_asteroid"; 
-                                    ++playerScore; // increment the if only a big asteroid destroyed
-                                }
-                                // create a explosion effect based on the asteroid type
-                                std::shared_ptr<GameObject> explosionObj = std::make_shared<Explosion>();
-                                explosionObj->settings((obj2->R == 10)? explosionAnim_1 : explosionAnim_2, obj2->x, obj2->y);
-                                gameObjs.push_back(explosionObj);
-                            }
-                        }
-                        else if (obj1->name == "spaceship"  and  obj2->name == "asteroid"){
-                            if ( isCollided(obj1, obj2) ){
-                                
-                                // upon collision between player and asteroid
-                                obj2->life = false;       --playerHealthCount; 
-                                // create a different explosion effect for the spaceship colliding
-                                std::shared_ptr<GameObject> explosionObj = std::make_shared<Explosion>();
-                                explosionObj->settings(explosionAnim_3, obj1->x, obj1->y);
-                                gameObjs.push_back(explosionObj);
-                                
-                                // play the sound when  player collided with an  asteroid
-                                if (explosionSound1.getStatus() != Sound::Playing){ explosionSound1.play(); }
-                                else { explosionSound1.stop(); }
-                                
-                                // block the ship movements after the collsion for some times by holding keyboard inputs
-                                inputBlocked = true;  inputClock.restart();
-                                spaceshipObj->dx = spaceshipObj->dy = 0;
-                                
-                                "------------------ Game Over Logic -----------------";
-                                if (playerHealthCount <= 0){ 
-                                    gameMessage("gameOver", 2, window);  
-                                    if (playerScore > std::stoi(getGameScore("HighestScore"))){
-                                        gameMessage("gameHighScore", 2, window);  
-                                    }
-                                    throw playerScore;
-                                }
-                            }
-                        }
-                    }
+                // start or stop the spaceship boost sound only when the boost changes
+                if (spaceshipBoost != boostSoundOn){
+                    if (spaceshipBoost){ audio.trigger(SHIP_BOOST_SOUND); }
+                    else { audio.release(SHIP_BOOST_SOUND); }
+                    boostSoundOn = spaceshipBoost;
                 }
-                // released the input flag and again allow keyboard inputs after holding for 1/2 seconds
-                if (inputBlocked  and  inputClock.getElapsedTime() >= seconds(0.5)){ inputBlocked = false; }
-                
+                // play the sound when  player collided with an  asteroid
+                if (events.shipHit){ audio.trigger(SHIP_EXPLOSION_SOUND); }
                 
-                ////// @c REMOVE-THE-EXPLOSION-OBJ'S-AFTER-ANIMATION,-AND-SPAWN-NEW-SMALL-ASTEROIDS ///////
-                
-                
-                for (auto &obj : gameObjs){
-                    if (obj->name == "explosion"){
-                        if (obj->animation.isEnd()){ obj->life = false; }
-                    }
-                    if (obj->name == "break_this_asteroid"){
-                        for (short int i = 0; i < 4; ++i){
-                            std::shared_ptr<GameObject> smallAsteroidObj = std::make_shared<Asteroid>();
-                            smallAsteroidObj->settings(smallAsteroidAnim, obj->x, obj->y, randNo(randGen)%360, 10);
-                            gameObjs.push_back(smallAsteroidObj);
-                        }
+                "------------------ Game Over Logic -----------------";
+                if (events.gameOver){ 
+                    gameMessage("gameOver", 2, window);  
+                    if (replaying){ window.close();  break; } // a replayed score is not saved
+                    if (saving){ std::remove(saveFile.c_str()); } // a lost game is not resumed
+                    if (world.playerScore > std::stoi(getGameScore("HighestScore"))){
+                        gameMessage("gameHighScore", 2, window);  
                     }
+                    throw world.playerScore;
                 }
-                
-                ///////////////////////// @c ALL-OBJECTS-UPDATE-LOGIC-FOR-EACH-FRAME ////////////////////////
-                
-                
-                // update the game objects one by one and remove if not needed
-                for (auto it = gameObjs.begin(); it != gameObjs.end(); ){
-                    auto eachObj = *it;
-                    
-                    eachObj->update();
-                    eachObj->animation.update();
-                    // erase current and points to the next element
-                    if (not eachObj->life){ it = gameObjs.erase(it); }
-                    else { ++it; } // manually increment the iterator, if obj life is true
-                }
-                
-                //////////////////////////// @c CREATE-A-NEW-WAVE /////////////////////////
-                
-                
-                // create asteroid objects randomly based on wave format
-                if (gameObjs.size() == 1){ // when only one obj is left which is spaceship
-                    waveLength += 5;       // increase the wave length whenever player clears a wave successfully
-                    waveNo++;              // track the wave no.
-                    
+                if (events.newWave){
                     // draw the background so that the window can be cleared.
-                    window.clear();  window.draw(background[ith_background]);
-                    gameMessage("gameWave", waveNo, window);
-                    
-                    for (short int i = 0; i < waveLength; ++i){
-                        std::shared_ptr<GameObject> bigAsteroidObj = std::make_shared<Asteroid>();
-                        bigAsteroidObj->settings(bigAsteroidAnim, randNo(randGen) % imgBack.getSize().x, 
-                                                randNo(randGen) % imgBack.getSize().y, randNo(randGen) % 360, 20);
-                        gameObjs.push_back(bigAsteroidObj);
-                    }
+                    window.clear();  window.draw(background);
+                    gameMessage("gameWave", world.waveNo, window);
+                    // the time spent on the wave message is not caught up
+                    frameClock.restart();  accumulator = 0.0F;
                 }
+                ASTEROID_PROFILE_MARK(INPUT_PHASE);
             }
             
             //////////////////////////// @c WINDOW-DRAW /////////////////////////
             
             
+            ASTEROID_PROFILE_MARK(DRAW_PHASE);
+            // a newly chosen background is loaded in the background, the last one is shown until it is ready
+            textures.update();
+            if (textures.find(backgroundIds[ith_background]) != nullptr){ shownBackground = backgroundIds[ith_background]; }
+            // finding it also keeps it resident (a background which could not be loaded is not drawn)
+            if (const Texture *shown = textures.find(shownBackground)){ background.setTexture(*shown, true); }
+            
             window.clear(); 
-            window.draw(background[ith_background]); // draw the the chosen background
+            window.draw(background); // draw the the chosen background
             if (inHomePage){ gameMessage("gameHomePage", 0, window); }
             else { 
-                for (auto &obj : gameObjs){ obj->draw(window); }            // draw game objs
-                gameMessage("gameScore", playerScore, window);              // draw score
+                float alpha = accumulator / tickTime;
+                const FloatRect *view = nullptr;
+                if (world.chunks.isLarge()){ // a large world is seen through the camera on the ship, the background tiles it
+                    const EntityPool &ships = world.gameObjs[SPACESHIP];
+                    std::size_t ship = world.ship();
+                    camera.setCenter(blendWrapped(ships.prevX[ship], ships.x[ship], alpha, worldW), 
+                                     blendWrapped(ships.prevY[ship], ships.y[ship], alpha, worldH));
+                    cameraRect = FloatRect(camera.getCenter() - camera.getSize() / 2.0F, camera.getSize());
+                    view = &cameraRect;
+                    window.setView(camera);
+                    
+                    float tileW = background.getTexture()->getSize().x, tileH = background.getTexture()->getSize().y;
+                    for (float ty = std::floor(cameraRect.top / tileH) * tileH; tileW > 0  and  ty < cameraRect.top + cameraRect.height; ty += tileH){
+                        for (float tx = std::floor(cameraRect.left / tileW) * tileW; tx < cameraRect.left + cameraRect.width; tx += tileW){
+                            background.setPosition(tx, ty);   window.draw(background);
+                        }
+                    }
+                    background.setPosition(0, 0);
+                }
+                spriteBatch.begin();
+                for (auto type : { SPACESHIP, BULLET, ASTEROID, HUNTER, EXPLOSION }){   // draw game objs
+                    drawEntities(world.gameObjs[type], clips, spriteBatch, alpha, view);
+                }
+                spriteBatch.flush(window);
+                // the stats count both passes of the batch, the world and the hearts on the screen
+                unsigned int drawCalls = spriteBatch.getDrawCalls(), unbatchedSprites = spriteBatch.getSpriteCount();
+                particleQuads.clear();                                         // draw the explosions, the colors add up
+                world.particles.addQuads(particleQuads, alpha, view);
+                window.draw(particleQuads, RenderStates(BlendAdd));
+                window.setView(window.getDefaultView());                       // the rest stays on the screen
                 
-                for (short int i = 0; i < playerHealthCount; ++i){             // draw health
-                    playerHealth.setPosition(1050 + i*imgHealth.getSize().x, 20);
-                    window.draw(playerHealth);
+                spriteBatch.begin();
+                for (short int i = 0; i < world.playerHealthCount; ++i){       // draw health
+                    spriteBatch.add(heartTexture, heartRect, Vector2f(0, 0), 1050 + i*heartRect.width, 20, 0);
                 }
-                if (holdFire){                                                 // draw hold fire msz if recharging
-                    short int rechargingCounter = static_cast<int>(fireHoldClock.getElapsedTime().asSeconds());
+                spriteBatch.flush(window);
+                drawCalls += spriteBatch.getDrawCalls();   unbatchedSprites += spriteBatch.getSpriteCount();
+                gameMessage("gameScore", world.playerScore, window);        // draw score
+                
+                if (world.holdFire){                                           // draw hold fire msz if recharging
+                    short int rechargingCounter = (world.tickNo - world.fireHoldTick) / ticksOf(1);
                     gameMessage("gameFireRecharge", (9 - rechargingCounter), window);
                 }
+                if (showDebugStats){                                           // draw the performance counters
+                    std::size_t objects = world.gameObjs.count();
+                    gameDebugStats("objects : " + std::to_string(objects)
+                                    + "\ncandidate pairs : " + std::to_string(world.candidatePairs)
+                                    + "  (all pairs : " + std::to_string(objects * objects) + ")"
+                                    + "\ndraw calls : " + std::to_string(drawCalls)
+                                    + "  (unbatched : " + std::to_string(unbatchedSprites) + ")"
+                                    + "\nparticles : " + std::to_string(world.particles.size()) + "  (budget " 
+                                                      + std::to_string(particleBudget) + " per tick, " 
+                                                      + std::to_string(world.particles.getCutCount()) + " cut)"
+                                    + "\nsprite textures : " + (atlasLoaded? std::to_string(atlas.getPageCount()) + " atlas pages" 
+                                                                              : std::to_string(ANIMATION_COUNT) + " sheets")
+                                    + "\nhit shapes : " + (hullsLoaded? std::to_string(rockHulls.getFrameCount()) + " asteroid frame hulls" : std::string("circles"))
+                                    + "\nresident textures : " + std::to_string(textures.getResidentBytes() >> 20) + " MB  (budget " 
+                                                              + std::to_string(textures.getBudgetBytes() >> 20) + " MB)"
+                                    + "\nstartup : " + std::to_string(startupTime.asMilliseconds()) + " ms to open the window,  audio : " 
+                                    + (audio.isLoaded()? std::to_string(audio.getResidentBytes() >> 10) + " KB decoded in " 
+                                                         + std::to_string(static_cast<int>(audio.getLoadMilliseconds())) + " ms on the loader thread, " 
+                                                         + std::to_string(audio.getStreamedCount()) + " streamed" : std::string("loading"))
+                                    + (world.chunks.isLarge()? "\nchunks : " + std::to_string(world.chunks.getAwakeCount()) + " of " 
+                                                   + std::to_string(world.chunks.getChunkCount()) + " awake, " 
+                                                   + std::to_string(world.chunks.getSleeperCount()) + " asteroids asleep  (" 
+                                                   + std::to_string(world.chunks.getWokenCount()) + " woken, " 
+                                                   + std::to_string(world.chunks.getSleptCount()) + " slept in the last tick)" : std::string())
+                                    + (world.gameObjs[HUNTER].size() > 0? "\nhunters : " + std::to_string(world.gameObjs[HUNTER].size()) 
+                                                   + ",  flow field " + std::to_string(world.flow.getCols()) + " x " + std::to_string(world.flow.getRows()) 
+                                                   + " built in " + std::to_string(world.flow.getBuildMicroseconds()) + " us  (" 
+                                                   + std::to_string(world.flow.getReusedCount()) + " of " + std::to_string(world.flow.getBuildCount()) 
+                                                   + " builds unchanged, " + std::to_string(world.flow.getLateCount()) + " late)" : std::string())
+                                    + (lastSave.empty()? std::string() : "\nsession save : " + lastSave + "  (F5 saves)")
+                                    + (spectators? "\nspectator stream : " + std::to_string(static_cast<int>(spectators->getBytesPerTick())) 
+                                                   + " bytes/tick" + (spectators->isWatched()? "" : "  (nobody watching)") : std::string())
+#ifdef ASTEROID_COUNT_ALLOCATIONS
+                                    + "\nheap allocations in the last tick : " + std::to_string(world.tickAllocations)
+#endif
+                                    , window);
+                }
+#ifdef ASTEROID_PROFILE
+                if (showProfiler){ gameDebugStats(profiler.overlayText(), window, 140); }
+#endif
             }
+            ASTEROID_PROFILE_MARK(PRESENT_PHASE);
             window.display();
+            ASTEROID_PROFILE_END_MARK();
+            ASTEROID_PROFILE_FRAME(world.gameObjs);
+        }
+        
+    }
+    
+    
+    ////////////////////////////////// @c SPECTATOR-WINDOW //////////////////////////////////
+    
+    
+    const double SPECTATOR_DELAY = 0.1; // seconds the spectator draws behind the stream, so two snapshots are there to blend
+    
+    // adds the entities of (from) to the batch, blended (alpha) of the way to the same entities in (to)
+    void drawSnapshot(const Snapshot &from, const Snapshot *to, float alpha, const AnimationClip *clips, SpriteBatch &batch){
+        
+        const float width = from.info.worldW, height = from.info.worldH;
+        const float stepX = width / 65535.0F, stepY = height / 65535.0F;
+        std::size_t n = 0;
+        for (const auto &entity : from.entities){
+            if (entity.clip >= ANIMATION_COUNT){ continue; }
+            float x = entity.x * stepX, y = entity.y * stepY, angle = entity.angle;
+            
+            // both lists are sorted by id, an entity which is gone in (to) stays where it was
+            while (to != nullptr  and  n < to->entities.size()  and  to->entities[n].id < entity.id){ ++n; }
+            if (to != nullptr  and  n < to->entities.size()  and  to->entities[n].id == entity.id){
+                const SnapshotEntity &next = to->entities[n];
+                float nextX = next.x * stepX, nextY = next.y * stepY;
+                // a jump larger than half the world is a wrap, it is not blended across the world
+                if (std::abs(nextX - x) < width / 2.0F){ x += (nextX - x) * alpha; }
+                if (std::abs(nextY - y) < height / 2.0F){ y += (nextY - y) * alpha; }
+                angle += static_cast<std::int8_t>(static_cast<std::uint8_t>(next.angle - entity.angle)) * alpha; // the shorter way round
+            }
+            const AnimationClip &clip = clips[entity.clip];
+            float frame = std::min<float>(entity.frame, clip.getFrameCount() - 1);
+            batch.add(clip.getTexture(), clip.frameAt(frame), clip.getOrigin(), x, y, angle * (360.0F / 256.0F) + 90.0F, 
+                      clip.getScale(), clipTint(entity.clip));
         }
+    }
+    
+    // the window of the spectator build (ASTEROID_SPECTATOR) : draws the stream of a game running with --publish
+    void Spectator(){
+        using namespace sf;
+        
+        TextureCache textures(textureBudgetMB << 20);
+        std::size_t backgroundId = textures.add("Images/Asteroid/background.jpg", false, true);
+        screenW = textures.load(backgroundId).getSize().x;   screenH = textures.load(backgroundId).getSize().y;
+        TextureAtlas atlas;
+        AnimationClip clips[ANIMATION_COUNT];
+        loadSpriteClips(textures, atlas, clips);
+        Texture heart;
+        heart.loadFromFile("Images/Asteroid/heartimage.png");
         
+        RenderWindow window(VideoMode(screenW, screenH), "Asteroid spectator");
+        window.setFramerateLimit(static_cast<unsigned int>(renderRate));
+        Sprite background(textures.load(backgroundId));
+        SpriteBatch spriteBatch;
+        SpectatorReceiver stream(IpAddress(spectatorHost), spectatorPort);
+        
+        Clock frameClock;
+        double renderTick = 0.0; // the game time drawn, in ticks of the game
+        Event e;
+        while (window.isOpen()){
+            while (window.pollEvent(e)){ if (e.type == Event::Closed){ window.close(); } }
+            stream.poll();
+            float frameTime = frameClock.restart().asSeconds();
+            
+            window.clear();
+            window.draw(background);
+            const Snapshot *newest = stream.find(stream.getNewestTick());
+            if (newest == nullptr){
+                gameDebugStats("waiting for the game at " + spectatorHost + " port " + std::to_string(spectatorPort), window);
+                window.display();
+                continue;
+            }
+            // the drawn time runs with the clock a bit behind the newest snapshot, it is pulled gently towards 
+            // that point and jumps when it is far off (the start, a stall of the game)
+            double rate = std::max<double>(newest->info.simulationRate, 1.0);
+            double target = newest->info.tick - std::max(2.0, SPECTATOR_DELAY * rate);
+            renderTick += frameTime * rate;
+            if (std::abs(renderTick - target) > rate * 0.5){ renderTick = target; }
+            else { renderTick += (target - renderTick) * 0.05; }
+            
+            // the last snapshot at or before the drawn time and the next one after it
+            const Snapshot *from = nullptr, *to = nullptr;
+            std::int64_t drawn = static_cast<std::int64_t>(std::floor(renderTick));
+            for (std::int64_t t = drawn; from == nullptr  and  t > 0  and  t > drawn - static_cast<std::int64_t>(SNAPSHOT_HISTORY); --t){ 
+                from = stream.find(static_cast<std::uint32_t>(t)); 
+            }
+            if (from == nullptr){ from = newest; }
+            for (std::uint32_t t = from->info.tick + 1; to == nullptr  and  t <= newest->info.tick; ++t){ to = stream.find(t); }
+            float alpha = (to != nullptr)? static_cast<float>((renderTick - from->info.tick) / (to->info.tick - from->info.tick)) : 0.0F;
+            alpha = std::min(1.0F, std::max(0.0F, alpha));
+            
+            // the whole world is fitted into the window
+            window.setView(View(FloatRect(0, 0, from->info.worldW, from->info.worldH)));
+            spriteBatch.begin();
+            drawSnapshot(*from, to, alpha, clips, spriteBatch);
+            spriteBatch.flush(window);
+            window.setView(window.getDefaultView());
+            
+            spriteBatch.begin();
+            IntRect heartRect(0, 0, heart.getSize().x, heart.getSize().y);
+            for (short int i = 0; i < from->info.health; ++i){ spriteBatch.add(&heart, heartRect, Vector2f(0, 0), 1050 + i*heartRect.width, 20, 0); }
+            spriteBatch.flush(window);
+            gameMessage("gameScore", from->info.score, window);
+            gameDebugStats("spectating " + spectatorHost + " port " + std::to_string(spectatorPort) + "  (wave " + std::to_string(from->info.wave) 
+                            + ", tick " + std::to_string(from->info.tick) + ")\nstream : " + std::to_string(static_cast<int>(stream.getBytesPerSnapshot())) 
+                            + " bytes per snapshot, " + std::to_string(from->entities.size()) + " entities", window, 60);
+            window.display();
+        }
     }
     
     
@@ -590,9 +4588,9 @@ namespace Asteroid {
             txt1.setFillColor(Color::Cyan);
             txt2.setFillColor(Color::Cyan);
             txt3.setFillColor(Color::Cyan);
-            txt1.setPosition(imgBack.getSize().x / 2 - 90,                imgBack.getSize().y / 2 - 60);
-            txt2.setPosition(imgBack.getSize().x / 2 - 95,                imgBack.getSize().y / 2 -  0);
-            txt3.setPosition(imgBack.getSize().x / 2 - 125/*155 for f1*/, imgBack.getSize().y / 2 + 60);
+            txt1.setPosition(screenW / 2 - 90,                screenH / 2 - 60);
+            txt2.setPosition(screenW / 2 - 95,                screenH / 2 -  0);
+            txt3.setPosition(screenW / 2 - 125/*155 for f1*/, screenH / 2 + 60);
             
             // LOGIC FOR MOUSE HOVERING AND TAPPING
             // get the positions of mouse and texts
@@ -640,14 +4638,14 @@ namespace Asteroid {
             txt.setString("GAME OVER !"); 
             txt.setFont(f1);
             txt.setFillColor(Color::Red);
-            txt.setPosition(imgBack.getSize().x / 2 - 80, imgBack.getSize().y / 2 - 45);
+            txt.setPosition(screenW / 2 - 80, screenH / 2 - 45);
             window.clear();
         }
         else if (m == "gameHighScore"){ 
             txt.setString("HIGH SCORE !"); 
             txt.setFont(f1);
             txt.setFillColor(Color::Green);
-            txt.setPosition(imgBack.getSize().x / 2 - 80, imgBack.getSize().y / 2 - 45);
+            txt.setPosition(screenW / 2 - 80, screenH / 2 - 45);
             window.clear();
         }
         else if (m == "gameScore"){
@@ -663,7 +4661,7 @@ namespace Asteroid {
             txt.setFont(f1);
             txt.setCharacterSize(60);
             txt.setFillColor(Color::Cyan);
-            txt.setPosition(imgBack.getSize().x / 2 - 125, imgBack.getSize().y / 2 - 45);
+            txt.setPosition(screenW / 2 - 125, screenH / 2 - 45);
             mszDuration = 2;
         }
         else if (m == "gameFireRecharge"){
@@ -679,7 +4677,7 @@ namespace Asteroid {
             txt.setString(m); 
             txt.setFillColor(Color::Yellow);
             txt.setFont(f2);
-            txt.setPosition(imgBack.getSize().x / 2 - 110, imgBack.getSize().y / 2 - 60);
+            txt.setPosition(screenW / 2 - 110, screenH / 2 - 60);
             window.clear();
         }
         window.draw(txt);  window.display();
@@ -687,6 +4685,102 @@ namespace Asteroid {
     }
     
     
+    // draws the given performance counters at the top left corner (below the fire recharge message)
+    void gameDebugStats(sf::String &&stats, sf::RenderWindow &window, float top){
+        
+        static sf::Font f2;  static bool fontLoaded = f2.loadFromFile("Fonts/cambria-math.ttf");
+        if (not fontLoaded){ return; }
+        
+        sf::Text txt(stats, f2, 16);
+        txt.setFillColor(sf::Color::Yellow);
+        txt.setPosition(10, top);
+        window.draw(txt);
+    }
+    
+    
+#endif // ASTEROID_HEADLESS
+    
+    
+    // reads the command line options
+    //   --sim-rate N    : fixed simulation ticks per second (default 120, the gameplay reference rate)
+    //   --render-rate N : frames per second drawn to the window (default 120)
+    //   --seed N        : seed of the simulation random numbers (default the clock, 2024 in the benchmark)
+    //   --record FILE   : write the input of every tick to FILE
+    //   --replay FILE   : play the recorded inputs of FILE back instead of the keyboard
+    //   --scenario FILE : play the spawn schedule of FILE (see the Scenario class), a replay needs the same one
+    //   --publish PORT  : stream the game to a spectator on UDP port PORT
+    //   --save FILE     : the file a closed game is saved to and resumed from (default AsteroidSave.sav)
+    //   --resume FILE   : start from the session saved in FILE (the game resumes --save by itself)
+    //   --world-screens N : play in a world of N x N screens (up to 32) with a camera following the ship (default 1)
+    //   --threads N     : worker threads of the simulation (default all the cores)
+    //   --trace FILE    : write the profiler timings as a Chrome trace (ASTEROID_PROFILE builds)
+    //   --texture-budget MB      : memory for the textures, the unused backgrounds are evicted (default 96)
+    //   --low-res-explosions 1   : keep the ship explosion sheet at half resolution
+    //   --particle-budget N      : explosion particles spawned per tick at most (default 1024)
+    //   --hunters N     : each wave brings N x the wave no. hunters chasing the ship (default 0)
+    // spectator build (ASTEROID_SPECTATOR) only
+    //   --watch PORT    : the port the game publishes on (default 7777)
+    //   --host ADDRESS  : the machine the game runs on (default 127.0.0.1)
+    // headless benchmark only
+    //   --save-at N     : write a checkpoint of the game after tick N to the --save file
+    //   --waves N       : waves to clear before the benchmark ends (default 10)
+    //   --max-ticks N   : stop after N ticks even if the waves are not cleared
+    //   --input MODE    : "scripted" (default) or "random" inputs
+    //   --wave-size N   : asteroids added by each new wave (default 5)
+    //   --scaling N     : run the benchmark with 1 to N threads and print the speedup
+    //   --narrowphase N : time the collision tests of bullets against N asteroids instead of the game
+    void parseOptions(int argc, char *argv[]){
+        
+        for (int i = 1; i + 1 < argc; i += 2){
+            std::string option = argv[i];
+            if (option == "--input"){ randomInputs = (std::string(argv[i + 1]) == "random");  continue; }
+            if (option == "--record"){ recordFile = argv[i + 1];  continue; }
+            if (option == "--replay"){ replayFile = argv[i + 1];  continue; }
+            if (option == "--trace"){ traceFile = argv[i + 1];  continue; }
+            if (option == "--scenario"){ scenarioFile = argv[i + 1];  continue; }
+            if (option == "--host"){ spectatorHost = argv[i + 1];  continue; }
+            if (option == "--save"){ saveFile = argv[i + 1];  continue; }
+            if (option == "--resume"){ resumeFile = argv[i + 1];  continue; }
+            if (option == "--seed"){ 
+                randomSeed = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+                randGen.seed(randomSeed);  seedGiven = true;  
+                continue; 
+            }
+            
+            float value = std::atof(argv[i + 1]);
+            if (value <= 0.0F){ continue; } // ignore the invalid values
+            
+            if (option == "--sim-rate"){ simulationRate = value; }
+            else if (option == "--render-rate"){ renderRate = value; }
+            else if (option == "--waves"){ benchmarkWaves = static_cast<short int>(value); }
+            else if (option == "--max-ticks"){ benchmarkMaxTicks = static_cast<std::uint64_t>(value); }
+            else if (option == "--threads"){ workerThreads = static_cast<unsigned int>(value); }
+            else if (option == "--wave-size"){ waveStep = static_cast<short int>(value); }
+            else if (option == "--scaling"){ benchmarkScaling = static_cast<unsigned int>(value); }
+            else if (option == "--narrowphase"){ benchmarkNarrowphase = static_cast<unsigned int>(value); }
+            else if (option == "--texture-budget"){ textureBudgetMB = static_cast<std::size_t>(value); }
+            else if (option == "--low-res-explosions"){ lowResExplosions = true; }
+            else if (option == "--particle-budget"){ particleBudget = static_cast<unsigned int>(value); }
+            else if (option == "--hunters"){ huntersPerWave = static_cast<unsigned int>(value); }
+            else if (option == "--publish"  or  option == "--watch"){ spectatorPort = static_cast<unsigned short>(value); }
+            else if (option == "--save-at"){ saveAtTick = static_cast<std::uint64_t>(value); }
+            else if (option == "--world-screens"){ worldScreens = std::min(32, static_cast<int>(value)); }
+        }
+        tickScale = REFERENCE_RATE / simulationRate;
+        worldW = screenW * std::max(1, worldScreens);   worldH = screenH * std::max(1, worldScreens);
+#ifdef ASTEROID_PROFILE
+        if (not traceFile.empty()){ profiler.enableTrace(1 << 20); }
+#endif
+    }
+    
+    // writes the trace file of the profiler, when it was asked for
+    void finishProfile(){
+#ifdef ASTEROID_PROFILE
+        if (not traceFile.empty()  and  not profiler.writeTrace(traceFile)){ std::cerr << "can not write " << traceFile << "\n"; }
+#endif
+    }
+    
+    
     // this func used to get the current or highest score of the player
     std::string getGameScore(std::string &&scoreType){
         
@@ -712,7 +4806,23 @@ namespace Asteroid {
 }
 
 
-int main(){
+#ifdef ASTEROID_HEADLESS
+int main(int argc, char *argv[]){
+    Asteroid::parseOptions(argc, argv);
+    Asteroid::Benchmark();
+    Asteroid::finishProfile();
+    return 0;
+}
+#elif defined(ASTEROID_SPECTATOR)
+int main(int argc, char *argv[]){
+    Asteroid::parseOptions(argc, argv);
+    if (Asteroid::spectatorPort == 0){ Asteroid::spectatorPort = 7777; }
+    Asteroid::Spectator();
+    return 0;
+}
+#else
+int main(int argc, char *argv[]){
+    Asteroid::parseOptions(argc, argv);
     try { 
         Asteroid::Main(); 
     }
@@ -726,5 +4836,7 @@ int main(){
             Asteroid::setGameScores(std::to_string(score), std::to_string(highScore)); 
         }
     }
+    Asteroid::finishProfile();
     return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// packs the Asteroid sprite sheets into atlas pages and writes the frame table read by the game,
+// run it from the "Asteroid Game" directory :  ./AtlasPacker [page size, default 4096]
+namespace AtlasPacker {
+
+    struct SheetLayout { const char *file;  int frameW, frameH, frameCount; };
+
+    // the sprite sheets of the game (the same frame layout as SPRITE_SHEETS in Code.cpp), and the heart
+    const SheetLayout SHEETS[] = {
+        { "Images/Asteroid/spaceship2.png",   45,  50,  1 },
+        { "Images/Asteroid/spaceship2_.png",  45,  70,  1 },
+        { "Images/Asteroid/bluefire.png",     32,  64, 16 },
+        { "Images/Asteroid/redfire.png",      32,  64, 16 },
+        { "Images/Asteroid/bigrocks.png",     64,  64, 16 },
+        { "Images/Asteroid/smallrocks.png",   64,  64, 16 },
+        { "Images/Asteroid/explosion3.png",  256, 256, 48 },
+        { "Images/Asteroid/heartimage.png",   40,  23,  1 }
+    };
+    const int PADDING = 2; // transparent texels around each frame, so the smooth filtering never reads a neighbour
+
+    struct PlacedFrame { int page, x, y; };
+
+
+    ////////////////////////////////// @c SHELF-PACKER //////////////////////////////////
+
+
+    class ShelfPacker { // fills a page row by row (shelves), a shelf is as high as the highest frame in it
+
+        private :
+
+        int pageSize, page, cursorX, shelfY, shelfH;
+        std::vector<int> pageHeights;
+        /*
+        cursorX, shelfY : where the next frame goes on the current shelf
+        shelfH          : height of the current shelf
+        pageHeights     : the used height of each page, the pages are cropped to it
+        */
+        public :
+
+        ShelfPacker(int size) noexcept { pageSize = size;  page = cursorX = shelfY = shelfH = 0;  pageHeights.push_back(0); }
+        ~ShelfPacker() noexcept {}
+
+        // the frames of a sheet are kept on one page, because an animation draws from one texture
+        bool fitsOnPage(const SheetLayout &sheet) const {
+            ShelfPacker trial(*this);
+            for (int f = 0; f < sheet.frameCount; ++f){ trial.place(sheet.frameW, sheet.frameH); }
+            return trial.pageHeights[page] <= pageSize;
+        }
+        void newPage(){ ++page;  cursorX = shelfY = shelfH = 0;  pageHeights.push_back(0); }
+
+        PlacedFrame place(int w, int h){
+            w += PADDING;  h += PADDING;
+            if (cursorX + w > pageSize){ shelfY += shelfH;  cursorX = shelfH = 0; } // start the next shelf
+            PlacedFrame placed{ page, cursorX + PADDING / 2, shelfY + PADDING / 2 };
+            cursorX += w;   shelfH = std::max(shelfH, h);
+            pageHeights[page] = std::max(pageHeights[page], shelfY + shelfH);
+            return placed;
+        }
+        inline const std::vector<int>& getPageHeights() const { return pageHeights; }
+    };
+
+
+    int Main(int pageSize){
+
+        const int sheetCount = sizeof(SHEETS) / sizeof(SHEETS[0]);
+        std::vector<sf::Image> images(sheetCount);
+        std::vector<int> order;
+        for (int i = 0; i < sheetCount; ++i){
+            if (not images[i].loadFromFile(SHEETS[i].file)){ std::cerr << "can not load " << SHEETS[i].file << "\n";  return 1; }
+            if (static_cast<int>(images[i].getSize().x) < SHEETS[i].frameW * SHEETS[i].frameCount){
+                std::cerr << SHEETS[i].file << " is smaller than its frame layout\n";  return 1;
+            }
+            if (SHEETS[i].frameW + PADDING > pageSize  or  SHEETS[i].frameH + PADDING > pageSize){
+                std::cerr << SHEETS[i].file << " has frames larger than a page\n";  return 1;
+            }
+            order.push_back(i);
+        }
+        // the highest frames first, so the shelves waste the least space
+        std::stable_sort(order.begin(), order.end(), [](int a, int b){ return SHEETS[a].frameH > SHEETS[b].frameH; });
+
+        ShelfPacker packer(pageSize);
+        std::vector<std::vector<PlacedFrame>> placed(sheetCount);
+        for (int i : order){
+            if (not packer.fitsOnPage(SHEETS[i])){ 
+                packer.newPage(); 
+                if (not packer.fitsOnPage(SHEETS[i])){ std::cerr << SHEETS[i].file << " does not fit on one page\n";  return 1; }
+            }
+            for (int f = 0; f < SHEETS[i].frameCount; ++f){ placed[i].push_back(packer.place(SHEETS[i].frameW, SHEETS[i].frameH)); }
+        }
+
+        // copy the frames into the pages
+        const std::vector<int> &heights = packer.getPageHeights();
+        std::vector<sf::Image> pages(heights.size());
+        for (std::size_t p = 0; p < pages.size(); ++p){ pages[p].create(pageSize, heights[p], sf::Color::Transparent); }
+        for (int i = 0; i < sheetCount; ++i){
+            for (int f = 0; f < SHEETS[i].frameCount; ++f){
+                const PlacedFrame &frame = placed[i][f];
+                pages[frame.page].copy(images[i], frame.x, frame.y,
+                                        sf::IntRect(f * SHEETS[i].frameW, 0, SHEETS[i].frameW, SHEETS[i].frameH));
+            }
+        }
+
+        // the frame table : the pages, then each sheet with one "page x y" line per frame
+        std::ofstream table("Images/Asteroid/atlas.txt");
+        table << "asteroid-atlas 1\n" << "pages " << pages.size() << "\n";
+        for (std::size_t p = 0; p < pages.size(); ++p){
+            std::string file = "Images/Asteroid/atlas" + std::to_string(p) + ".png";
+            if (not pages[p].saveToFile(file)){ std::cerr << "can not write " << file << "\n";  return 1; }
+            table << file << "\n";
+            std::cout << file << " : " << pageSize << " x " << heights[p] << "\n";
+        }
+        for (int i = 0; i < sheetCount; ++i){
+            table << "sheet " << SHEETS[i].file << " " << SHEETS[i].frameW << " " << SHEETS[i].frameH << " " << SHEETS[i].frameCount << "\n";
+            for (const auto &frame : placed[i]){ table << frame.page << " " << frame.x << " " << frame.y << "\n"; }
+        }
+        return table? 0 : 1;
+    }
+}
+
+
+int main(int argc, char *argv[]){
+    int pageSize = (argc > 1)? std::atoi(argv[1]) : 4096;
+    // a page must fit in a texture of the weakest GPUs the game runs on
+    if (pageSize < 256){ pageSize = 4096; }
+    return AtlasPacker::Main(pageSize);
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// bakes the convex hull of every asteroid frame from the sprite alpha and writes the hull table read by the game,
+// run it from the "Asteroid Game" directory :  ./HullBaker [alpha threshold 1 - 255, default 128]
+namespace HullBaker {
+
+    struct SheetLayout { const char *file;  int frameW, frameH, frameCount; };
+
+    // the asteroid sheets (the same frame layout as SPRITE_SHEETS in Code.cpp)
+    const SheetLayout SHEETS[] = {
+        { "Images/Asteroid/bigrocks.png",   64, 64, 16 },
+        { "Images/Asteroid/smallrocks.png", 64, 64, 16 }
+    };
+    const int MAX_VERTICES = 12; // HULL_MAX_VERTICES of the game, a pair is tested on at most this many edge normals
+
+    struct Point { long x, y; };
+
+    inline long cross(const Point &o, const Point &a, const Point &b){ return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); }
+
+
+    ////////////////////////////////// @c CONVEX-HULL //////////////////////////////////
+
+
+    // the corners of the outermost opaque pixels of each row of a frame, every opaque pixel is inside their hull
+    std::vector<Point> opaqueCorners(const sf::Image &image, const SheetLayout &sheet, int frame, int threshold){
+        std::vector<Point> corners;
+        for (int y = 0; y < sheet.frameH; ++y){
+            int first = -1, last = -1;
+            for (int x = 0; x < sheet.frameW; ++x){
+                if (image.getPixel(frame * sheet.frameW + x, y).a < threshold){ continue; }
+                if (first < 0){ first = x; }
+                last = x;
+            }
+            if (first < 0){ continue; }
+            for (long cornerY : { y, y + 1 }){ corners.push_back(Point{ first, cornerY });  corners.push_back(Point{ last + 1, cornerY }); }
+        }
+        return corners;
+    }
+
+    // the convex hull of the points (monotone chain), without the points on its edges
+    std::vector<Point> convexHull(std::vector<Point> points){
+        std::sort(points.begin(), points.end(), [](const Point &a, const Point &b){ return (a.x != b.x)? a.x < b.x : a.y < b.y; });
+        points.erase(std::unique(points.begin(), points.end(), [](const Point &a, const Point &b){ return a.x == b.x  and  a.y == b.y; }),
+                     points.end());
+        if (points.size() < 3){ return points; }
+
+        std::vector<Point> hull(points.size() * 2);
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < points.size(); ++i){                       // the lower chain
+            while (k >= 2  and  cross(hull[k - 2], hull[k - 1], points[i]) <= 0){ --k; }
+            hull[k++] = points[i];
+        }
+        for (std::size_t i = points.size() - 1, lower = k + 1; i > 0; --i){   // the upper chain
+            while (k >= lower  and  cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0){ --k; }
+            hull[k++] = points[i - 1];
+        }
+        hull.resize(k - 1); // the last point is the first one again
+        return hull;
+    }
+
+    // drops the vertex which cuts the least area off the hull until (MAX_VERTICES) are left, the hull stays
+    // convex and inside the sprite (a bullet grazing a dropped corner misses)
+    void simplify(std::vector<Point> &hull){
+        while (static_cast<int>(hull.size()) > MAX_VERTICES){
+            std::size_t cheapest = 0;  long smallest = -1;
+            for (std::size_t v = 0; v < hull.size(); ++v){
+                const Point &before = hull[(v + hull.size() - 1) % hull.size()], &after = hull[(v + 1) % hull.size()];
+                long area = std::labs(cross(before, hull[v], after));
+                if (smallest < 0  or  area < smallest){ smallest = area;  cheapest = v; }
+            }
+            hull.erase(hull.begin() + cheapest);
+        }
+    }
+
+
+    int Main(int threshold){
+
+        // the hull table : each sheet, then one "<vertex count> x y ..." line per frame around the frame center
+        std::ofstream table("Images/Asteroid/hulls.txt");
+        table << "asteroid-hulls 1\n";
+        for (const auto &sheet : SHEETS){
+            sf::Image image;
+            if (not image.loadFromFile(sheet.file)){ std::cerr << "can not load " << sheet.file << "\n";  return 1; }
+            if (static_cast<int>(image.getSize().x) < sheet.frameW * sheet.frameCount  or  static_cast<int>(image.getSize().y) < sheet.frameH){
+                std::cerr << sheet.file << " is smaller than its frame layout\n";  return 1;
+            }
+            table << "sheet " << sheet.file << " " << sheet.frameW << " " << sheet.frameH << " " << sheet.frameCount << "\n";
+
+            std::size_t vertices = 0;
+            for (int f = 0; f < sheet.frameCount; ++f){
+                std::vector<Point> hull = convexHull(opaqueCorners(image, sheet, f, threshold));
+                if (hull.size() < 3){ std::cerr << sheet.file << " frame " << f << " has no opaque area\n";  return 1; }
+                simplify(hull);
+                vertices += hull.size();
+
+                table << hull.size();
+                for (const auto &point : hull){ table << " " << point.x - sheet.frameW / 2.0 << " " << point.y - sheet.frameH / 2.0; }
+                table << "\n";
+            }
+            std::cout << sheet.file << " : " << sheet.frameCount << " hulls, " << vertices / static_cast<double>(sheet.frameCount)
+                      << " vertices each\n";
+        }
+        return table? 0 : 1;
+    }
+}
+
+
+int main(int argc, char *argv[]){
+    int threshold = (argc > 1)? std::atoi(argv[1]) : 128;
+    // a pixel at least this opaque is part of the asteroid
+    if (threshold < 1  or  threshold > 255){ threshold = 128; }
+    return HullBaker::Main(threshold);
+}
\ No newline at end of file